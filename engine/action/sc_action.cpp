@@ -236,6 +236,7 @@ struct action_execute_event_t : public player_event_t
       // Action target must follow any potential pre-execute-state target if it differs from the
       // current (default) target of the action.
       action -> set_target( target );
+      cpu_profile_scope_t profile( action -> cpu_profile( cpu_profile_t::EXECUTE ) );
       action -> execute();
     }
 
@@ -400,6 +401,7 @@ action_t::action_t( action_e       ty,
   use_off_gcd(),
   interrupt_auto_attack( true ),
   ignore_false_positive(),
+  cooldown_gated_ready( true ),
   action_skill( p -> base.skill ),
   direct_tick(),
   repeating(),
@@ -497,6 +499,7 @@ action_t::action_t( action_e       ty,
   action_list(),
   starved_proc(),
   total_executions(),
+  cpu_profile_entries(),
   line_cooldown( "line_cd", *p ),
   signature(),
   execute_state(),
@@ -1250,6 +1253,23 @@ double action_t::calculate_crit_damage_bonus( action_state_t* state ) const
   return state -> result_total;
 }
 
+// action_t::cpu_profile =====================================================
+
+cpu_profile_t* action_t::cpu_profile( cpu_profile_t::action_phase_e phase )
+{
+  if ( ! sim -> event_mgr.monitor_cpu )
+    return nullptr;
+
+  cpu_profile_t*& entry = cpu_profile_entries[ phase ];
+  if ( ! entry )
+  {
+    static const char* categories[] = { "Execute", "Impact", "Tick" };
+    entry = &sim -> event_mgr.profile( categories[ phase ], player -> name_str + "/" + name_str );
+  }
+
+  return entry;
+}
+
 // action_t::consume_resource ===============================================
 
 void action_t::consume_resource()
@@ -1402,6 +1422,8 @@ void action_t::execute()
   }
 #endif
 
+  sim -> expr_generation++;
+
   if ( &data() == &spell_data_not_found_t::singleton )
   {
     sim -> errorf( "Player %s could not find spell data for action %s\n", player -> name(), name() );
@@ -1884,19 +1906,14 @@ bool action_t::usable_moving() const
 
 bool action_t::ready()
 {
-  // Check conditions that do NOT pertain to the target before cycle_targets
-  if ( cooldown -> is_ready() == false )
-    return false;
-
-  if ( internal_cooldown -> down() )
+  // Check conditions that do NOT pertain to the target before cycle_targets. The cooldown gates
+  // are also checked by player_t::select_action before calling ready(), so keep them first.
+  if ( cooldown_gates_down() )
     return false;
 
   if ( rng().roll( false_negative_pct() ) )
     return false;
 
-  if ( line_cooldown.down() )
-    return false;
-
   if ( sync_action && ! sync_action -> ready() )
     return false;
 
@@ -1943,7 +1960,10 @@ bool action_t::ready()
     // Note, need to take a copy of the original target list here, instead of a reference. Otherwise
     // if spell_targets (or any expression that uses the target list) modifies it, the loop below
     // may break, since the number of elements on the vector is not the same as it originally was
-    std::vector< player_t* > ctl = target_list();
+    std::vector< player_t* >& ctl = cycle_targets_snapshot;
+    const std::vector< player_t* >& tl = target_list();
+    ctl.assign( tl.begin(), tl.end() );
+    uint64_t generation = sim -> target_non_sleeping_list.generation();
     size_t num_targets = ctl.size();
 
     if ( ( option.max_cycle_targets > 0 ) && ( ( size_t ) option.max_cycle_targets < num_targets ) )
@@ -1951,6 +1971,10 @@ bool action_t::ready()
 
     for ( size_t i = 0; i < num_targets; i++ )
     {
+      // Targets may have gone to sleep while evaluating the previous ones
+      if ( generation != sim -> target_non_sleeping_list.generation() && ctl[ i ] -> is_sleeping() )
+        continue;
+
       target = ctl[i];
       if ( ready() )
       {
@@ -2046,12 +2070,58 @@ bool action_t::ready()
   if ( rng().roll( false_positive_pct() ) )
     return true;
 
-  if ( if_expr && !if_expr -> success() )
+  if ( if_expr && evaluate_expr( if_expr, if_program ) == 0 )
     return false;
 
   return true;
 }
 
+// action_t::evaluate_expr ==================================================
+
+double action_t::evaluate_expr( expr_t* expr, expression::program_t& program )
+{
+  if ( ! program.compiled( expr ) )
+    return expr -> eval();
+
+  if ( ! sim -> apl_compiler_verify )
+    return program.run();
+
+  double compiled_v = program.run();
+  double tree_v = expr -> eval();
+
+  // The tree evaluator stays authoritative in verify mode, so a mismatch
+  // cannot change the outcome of the rest of the iteration.
+  if ( compiled_v != tree_v && ! ( std::isnan( compiled_v ) && std::isnan( tree_v ) ) )
+  {
+    if ( program.mismatches++ == 0 )
+    {
+      sim -> errorf( "Player %s action %s compiled expression result %f differs from expression tree result %f at %.3f, iteration %d",
+                     player -> name(), signature_str.c_str(), compiled_v, tree_v,
+                     sim -> current_time().total_seconds(), sim -> current_iteration );
+    }
+  }
+
+  return tree_v;
+}
+
+// action_t::compile_expressions ============================================
+
+void action_t::compile_expressions()
+{
+  if_program.clear();
+  target_if_program.clear();
+
+  if ( ! sim -> apl_compiler )
+    return;
+
+  // Expressions the compiler declines keep evaluating through the tree
+  if ( if_expr )
+    if_program.compile( if_expr );
+
+  if ( target_if_expr )
+    target_if_program.compile( target_if_expr );
+}
+
 // action_t::init ===========================================================
 
 void action_t::init()
@@ -2251,6 +2321,14 @@ bool action_t::init_finished()
     ret = false;
   }
 
+  // Fold constants (talents, artifact traits, set bonuses) right away.
+  // Analyzing expressions gather statistics through the first iteration and
+  // are optimized in reset() instead.
+  if ( ret && ! sim -> optimize_expressions )
+  {
+    optimize_expressions();
+  }
+
   return ret;
 }
 
@@ -2273,24 +2351,53 @@ void action_t::reset()
 
   if( sim -> current_iteration == 1 )
   {
-    if( if_expr )
+    optimize_expressions();
+  }
+}
+
+// action_t::optimize_expressions ===========================================
+
+void action_t::optimize_expressions()
+{
+  if( if_expr )
+  {
+    if_expr = if_expr -> optimize();
+    // The action can never be ready, drop the line from the priority list
+    if ( action_list && if_expr -> always_false() )
     {
-      if_expr = if_expr -> optimize();
-      if ( sim -> optimize_expressions && action_list && if_expr -> always_false() )
+      std::vector<action_t*>::iterator i = std::find( action_list -> foreground_action_list.begin(),
+                                                      action_list -> foreground_action_list.end(),
+                                                      this );
+      if ( i != action_list -> foreground_action_list.end() )
       {
-        std::vector<action_t*>::iterator i = std::find( action_list -> foreground_action_list.begin(),
-                                                        action_list -> foreground_action_list.end(),
-                                                        this );
-        if ( i != action_list -> foreground_action_list.end() )
+        size_t position = std::distance( action_list -> foreground_action_list.begin(), i );
+        action_list -> foreground_action_list.erase( i );
+
+        // Lists called from this one record the position of the call (see call_action_list_t::init),
+        // keep them pointing at the same line. A call on the dropped line keeps its position, the
+        // lines above it are the same and the dropped line was never ready.
+        for ( auto apl : player -> action_priority_list )
         {
-          action_list -> foreground_action_list.erase( i );
+          // Compiled lists may contain the dropped line
+          apl -> program.clear();
+
+          for ( auto& parent : apl -> parents )
+          {
+            if ( std::get<0>( parent ) == action_list && std::get<1>( parent ) > position )
+            {
+              --std::get<1>( parent );
+            }
+          }
         }
       }
     }
-    if ( target_if_expr ) target_if_expr = target_if_expr -> optimize();
-    if( interrupt_if_expr ) interrupt_if_expr = interrupt_if_expr -> optimize();
-    if( early_chain_if_expr ) early_chain_if_expr = early_chain_if_expr -> optimize();
   }
+  if ( target_if_expr ) target_if_expr = target_if_expr -> optimize();
+  if( interrupt_if_expr ) interrupt_if_expr = interrupt_if_expr -> optimize();
+  if( early_chain_if_expr ) early_chain_if_expr = early_chain_if_expr -> optimize();
+
+  // Expressions are in their final form now, lower them
+  compile_expressions();
 }
 
 // action_t::cancel =========================================================
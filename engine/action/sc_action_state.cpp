@@ -246,6 +246,7 @@ void travel_event_t::execute()
 {
   if ( !state->target->is_sleeping() )
   {
+    cpu_profile_scope_t profile( action->cpu_profile( cpu_profile_t::IMPACT ) );
     action->impact( state );
   }
 
@@ -162,25 +162,24 @@ player_t* action_t::select_target_if_target()
     // evaluates to non-zero
     if ( target_if_mode == TARGET_IF_FIRST )
     {
-      return target_if_expr->evaluate() > 0 ? target : nullptr;
+      return evaluate_expr( target_if_expr, target_if_program ) > 0 ? target : nullptr;
     }
     // For the rest (min/max), return the target
     return target;
   }
 
-  std::vector<player_t*> master_list;
+  // Iterate over a snapshot of the target list, since evaluating target_if may regenerate the
+  // target cache. The snapshot buffer is reused between calls.
+  std::vector<player_t*>& master_list = target_if_snapshot;
   if ( sim->distance_targeting_enabled )
   {
     if ( !target_cache.is_valid )
     {
       available_targets( target_cache.list );
-      master_list           = targets_in_range_list( target_cache.list );
+      targets_in_range_list( target_cache.list );
       target_cache.is_valid = true;
     }
-    else
-    {
-      master_list = target_cache.list;
-    }
+    master_list.assign( target_cache.list.begin(), target_cache.list.end() );
     if ( sim->log )
       sim->out_debug.printf( "%s Number of targets found in range - %.3f",
                              player->name(),
@@ -190,12 +189,14 @@ player_t* action_t::select_target_if_target()
   }
   else
   {
-    master_list = target_list();
+    const std::vector<player_t*>& tl = target_list();
+    master_list.assign( tl.begin(), tl.end() );
   }
+  uint64_t generation = sim->target_non_sleeping_list.generation();
 
   player_t* original_target = target;
   player_t* proposed_target = target;
-  double current_target_v   = target_if_expr->evaluate();
+  double current_target_v   = evaluate_expr( target_if_expr, target_if_program );
 
   double max_ = current_target_v;
   double min_ = current_target_v;
@@ -208,7 +209,12 @@ player_t* action_t::select_target_if_target()
     if ( target == original_target )
       continue;
 
-    double v = target_if_expr->evaluate();
+    // Targets may have gone to sleep while evaluating the previous ones
+    if ( generation != sim->target_non_sleeping_list.generation() &&
+         target->is_sleeping() )
+      continue;
+
+    double v = evaluate_expr( target_if_expr, target_if_program );
 
     // Don't swap to targets that evaluate to identical value than the current
     // target
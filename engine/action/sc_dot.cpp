@@ -52,6 +52,8 @@ void dot_t::extend_duration( timespan_t extra_seconds,
   if ( !ticking )
     return;
 
+  sim.expr_generation++;
+
   if ( state_flags == (uint32_t)-1 )
     state_flags = current_action->snapshot_flags;
 
@@ -94,6 +96,8 @@ void dot_t::reduce_duration( timespan_t remove_seconds, uint32_t state_flags )
   if ( !ticking )
     return;
 
+  sim.expr_generation++;
+
   if ( state_flags == (uint32_t)-1 )
     state_flags = current_action->snapshot_flags;
 
@@ -208,6 +212,8 @@ void dot_t::decrement( int stacks = 1 )
   if ( max_stack == 0 || stack <= 0 )
     return;
 
+  sim.expr_generation++;
+
   if ( stacks == 0 || stack <= stacks )
   {
     cancel();
@@ -966,6 +972,7 @@ void dot_t::tick()
         current_tick, num_ticks, last_start.total_seconds(),
         current_duration.total_seconds(), time_to_tick.total_seconds() );
 
+  cpu_profile_scope_t profile( current_action->cpu_profile( cpu_profile_t::TICK ) );
   current_action->tick( this );
 }
 
@@ -973,6 +980,8 @@ void dot_t::tick()
  */
 void dot_t::last_tick()
 {
+  sim.expr_generation++;
+
   if ( sim.debug )
     sim.out_debug.printf( "%s fades from %s", name(), state->target->name() );
 
@@ -1051,6 +1060,8 @@ void dot_t::schedule_tick()
 
 void dot_t::start( timespan_t duration )
 {
+  sim.expr_generation++;
+
   current_duration = duration;
   last_start       = sim.current_time();
 
@@ -1083,6 +1094,8 @@ void dot_t::start( timespan_t duration )
  */
 void dot_t::refresh( timespan_t duration )
 {
+  sim.expr_generation++;
+
   current_duration =
       current_action->calculate_dot_refresh_duration( this, duration );
 
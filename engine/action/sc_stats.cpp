@@ -43,6 +43,17 @@ stats_t::stats_t( const std::string& n, player_t* p ) :
   scaling( nullptr ),
   timeline_amount( nullptr )
 {
+  if ( sim.statistics_sketch || sim.statistics_compact )
+  {
+    for ( auto sd : { &actual_amount, &total_amount, &portion_aps, &portion_apse } )
+    {
+      if ( sim.statistics_sketch )
+        sd -> use_sketch();
+      else
+        sd -> use_compact();
+    }
+  }
+
   int size = std::min( sim.iterations, 10000 );
   actual_amount.reserve( size );
   total_amount.reserve( size );
@@ -52,6 +63,7 @@ stats_t::stats_t( const std::string& n, player_t* p ) :
   if ( sim.report_details != 0 )
   {
     timeline_amount = std::unique_ptr<sc_timeline_t>( new sc_timeline_t() );
+    timeline_amount -> reserve( timespan_t::from_seconds( sim.expected_max_time() ) );
   }
 }
 
@@ -238,6 +238,10 @@ buff_t::buff_t( const buff_creation::buff_creator_basics_t& params ) :
   // Set Buff Cooldown
   set_cooldown( params._cooldown );
 
+  if ( sim -> buff_uptime_timeline )
+  {
+    uptime_array.reserve( timespan_t::from_seconds( sim -> expected_max_time() ) );
+  }
 
   // If the params specifies a trigger spell (even if it's not found), use it instead of the actual
   // spell data of the buff.
@@ -991,6 +995,8 @@ void buff_t::decrement( int    stacks,
 
     if ( requires_invalidation ) invalidate_cache();
 
+    sim -> expr_generation++;
+
     if ( as<std::size_t>( current_stack ) < stack_uptime.size() )
       stack_uptime[ current_stack ].update( false, sim -> current_time() );
 
@@ -1033,6 +1039,8 @@ void buff_t::extend_duration( player_t* p, timespan_t extra_seconds )
 
   assert( expiration.size() == 1 );
 
+  sim -> expr_generation++;
+
   if ( extra_seconds > timespan_t::zero() )
   {
     expiration.front() -> reschedule( expiration.front() -> remains() + extra_seconds );
@@ -1100,6 +1108,8 @@ void buff_t::start( int        stacks,
 
   start_count++;
 
+  sim -> expr_generation++;
+
   if ( player && change_regen_rate )
     player -> do_dynamic_regen();
   else if ( change_regen_rate )
@@ -1244,6 +1254,8 @@ void buff_t::bump( int stacks, double value )
 {
   if ( _max_stack == 0 ) return;
 
+  sim -> expr_generation++;
+
   current_value = value;
 
   if ( requires_invalidation ) invalidate_cache();
@@ -1391,6 +1403,8 @@ void buff_t::expire( timespan_t delay )
     event_t::cancel( expiration_delay );
   }
 
+  sim -> expr_generation++;
+
   timespan_t remaining_duration = timespan_t::zero();
   int expiration_stacks = current_stack;
   if ( ! expiration.empty() )
@@ -1554,6 +1554,10 @@ void enemy_t::recalculate_health()
 {
   if ( sim -> expected_iteration_time <= timespan_t::zero() || fixed_health > 0 ) return;
 
+  // Deterministic sims keep the health estimated in the calibration iteration, which is the same
+  // in every thread. Results then do not depend on which thread simulates an iteration.
+  if ( sim -> deterministic && initial_health > 0 ) return;
+
   if ( initial_health == 0 ) // first iteration
   {
     initial_health = iteration_dmg_taken * ( sim -> expected_iteration_time / sim -> current_time() ) * ( 1.0 / ( 1.0 - death_pct / 100 ) );
@@ -4659,6 +4659,9 @@ struct keg_smash_t: public monk_melee_attack_t
     // Forcing the trigger GCD to 1 second.
     trigger_gcd = timespan_t::from_seconds( 1 );
 
+    // Usable while on cooldown when Secret Ingredients procs, see ready()
+    cooldown_gated_ready = false;
+
     if ( p.artifact.stave_off.rank() )
       add_child( stave_off );
   }
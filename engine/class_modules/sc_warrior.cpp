@@ -4584,6 +4584,8 @@ struct taunt_t: public warrior_spell_t
   {
     parse_options( options_str );
     use_off_gcd = ignore_false_positive = true;
+    // Warlord's Challenge makes Taunt usable while on cooldown, see ready()
+    cooldown_gated_ready = false;
   }
 
   void impact( action_state_t* s ) override
@@ -779,7 +779,8 @@ player_t::player_t( sim_t*             s,
   regen_caches( CACHE_MAX ),
   dynamic_regen_pets( false ),
   visited_apls_( 0 ),
-  action_list_id_( 0 )
+  action_list_id_( 0 ),
+  apl_cpu_profile( nullptr )
 {
   actor_index = sim -> actor_list.size();
   sim -> actor_list.push_back( this );
@@ -4537,6 +4538,8 @@ void player_t::arise()
   if ( current.sleeping )
     return;
 
+  sim -> expr_generation++;
+
   actor_spawn_index = sim -> global_spawn_index++;
 
   if ( sim -> log )
@@ -4613,6 +4616,8 @@ void player_t::demise()
   if ( sim -> log )
     sim -> out_log.printf( "%s demises.. Spawn Index=%u", name(), actor_spawn_index );
 
+  sim -> expr_generation++;
+
   /* Do not reset spawn index, because the player can still have damaging events ( dots ) which
    * need to be associated with eg. resolve Diminishing Return list.
    */
@@ -4771,7 +4776,17 @@ action_t* player_t::execute_action()
   if ( ! strict_sequence )
   {
     visited_apls_ = 0; // Reset visited apl list
-    action = select_action( *active_action_list );
+
+    if ( sim -> event_mgr.monitor_cpu && ! apl_cpu_profile )
+    {
+      apl_cpu_profile = &sim -> event_mgr.profile( "APL", name_str );
+    }
+
+    cpu_profile_scope_t profile( apl_cpu_profile );
+    if ( sim -> apl_compiler )
+      action = select_compiled_action( *active_action_list );
+    else
+      action = select_action( *active_action_list );
   }
   // Committed to a strict sequence of actions, just perform them instead of a priority list
   else
@@ -4898,6 +4913,8 @@ double player_t::resource_loss( resource_e resource_type,
   if ( current.sleeping )
     return 0.0;
 
+  sim -> expr_generation++;
+
   if ( resource_type == primary_resource() )
     uptimes.primary_resource_cap -> update( false, sim -> current_time() );
 
@@ -4949,6 +4966,8 @@ double player_t::resource_gain( resource_e resource_type,
   if ( current.sleeping || amount == 0.0 )
     return 0.0;
 
+  sim -> expr_generation++;
+
   double actual_amount = std::min( amount, resources.max[ resource_type ] - resources.current[ resource_type ] );
 
   if ( actual_amount > 0.0 )
@@ -5125,6 +5144,8 @@ void player_t::stat_gain( stat_e    stat,
   // bail out if this is a stat that doesn't work for this class
   if ( convert_hybrid_stat( stat ) == STAT_NONE ) return;
 
+  sim -> expr_generation++;
+
   int temp_value = temporary_stat ? 1 : 0;
 
   cache_e cache_type = cache_from_stat( stat );
@@ -5253,6 +5274,8 @@ void player_t::stat_loss( stat_e    stat,
   // bail out if this is a stat that doesn't work for this class
   if ( convert_hybrid_stat( stat ) == STAT_NONE ) return;
 
+  sim -> expr_generation++;
+
   cache_e cache_type = cache_from_stat( stat );
   if ( regen_type == REGEN_DYNAMIC && regen_caches[ cache_type ] )
     do_dynamic_regen();
@@ -9443,16 +9466,6 @@ expr_t* player_t::create_expression( action_t* a,
 
   if ( ( splits.size() == 3 ) && splits[ 0 ] == "talent" )
   {
-    struct s_expr_t : public player_expr_t
-    {
-      spell_data_t* s;
-
-      s_expr_t( const std::string& name, player_t& p, spell_data_t* sp ) :
-        player_expr_t( name, p ), s( sp ) {}
-      virtual double evaluate() override
-      { return ( s && s -> ok() ); }
-    };
-
     if ( splits[ 2 ] != "enabled" )
     {
       return 0;
@@ -9465,10 +9478,8 @@ expr_t* player_t::create_expression( action_t* a,
       s = const_cast< spell_data_t* >( find_talent_spell( splits[ 1 ], specialization(), true ) );
     }
 
-    if( sim -> optimize_expressions )
-      return expr_t::create_constant( expression_str, ( s && s -> ok() ) ? 1.0 : 0.0 );
-    else
-      return new s_expr_t( expression_str, *this, s );
+    // Talents are fixed for the whole sim
+    return expr_t::create_constant( expression_str, ( s && s -> ok() ) ? 1.0 : 0.0 );
   }
   else if ( splits.size() == 3 && splits[ 0 ] == "artifact" && ( splits[ 2 ] == "enabled" || splits[ 2 ] == "rank" ) )
   {
@@ -10305,28 +10316,28 @@ void player_convergence( int convergence_scale,
   int    convergence_iterations = 0;
   double convergence_std_dev = 0;
 
-  if ( dps.data().size() > 1 && convergence_scale > 1 && !dps.simple )
+  if ( dps.stored_samples() > 1 && convergence_scale > 1 && !dps.simple )
   {
     double convergence_dps = 0;
     double convergence_min = +1.0E+50;
     double convergence_max = -1.0E+50;
-    for ( unsigned int i = 0; i < dps.data().size(); i += convergence_scale )
+    for ( unsigned int i = 0; i < dps.stored_samples(); i += convergence_scale )
     {
-      double i_dps = dps.data()[ i ];
+      double i_dps = dps.sample( i );
       convergence_dps += i_dps;
       if ( convergence_min > i_dps ) convergence_min = i_dps;
       if ( convergence_max < i_dps ) convergence_max = i_dps;
     }
-    convergence_iterations = ( as<int>( dps.data().size() ) + convergence_scale - 1 ) / convergence_scale;
+    convergence_iterations = ( as<int>( dps.stored_samples() ) + convergence_scale - 1 ) / convergence_scale;
     convergence_dps /= convergence_iterations;
 
-    dps_convergence_error.assign( dps.data().size(), 0 );
+    dps_convergence_error.assign( dps.stored_samples(), 0 );
 
     double sum_of_squares = 0;
 
-    for ( unsigned int i = 0; i < dps.data().size(); i++ )
+    for ( unsigned int i = 0; i < dps.stored_samples(); i++ )
     {
-      double delta = dps.data()[ i ] - convergence_dps;
+      double delta = dps.sample( i ) - convergence_dps;
       double delta_squared = delta * delta;
 
       sum_of_squares += delta_squared;
@@ -11153,6 +11164,23 @@ player_collected_data_t::player_collected_data_t( const player_t* player ) :
   total_iterations( 0 ),
   buffed_stats_snapshot()
 {
+  // Fight length samples are needed as-is to normalize timelines
+  if ( player -> sim -> statistics_sketch || player -> sim -> statistics_compact )
+  {
+    for ( auto sd : { &waiting_time, &pooling_time, &executed_foreground_actions,
+                      &dmg, &compound_dmg, &prioritydps, &dps, &dpse, &dtps, &dmg_taken,
+                      &heal, &compound_heal, &hps, &hpse, &htps, &heal_taken,
+                      &absorb, &compound_absorb, &aps, &atps, &absorb_taken,
+                      &deaths, &theck_meloree_index, &effective_theck_meloree_index,
+                      &max_spike_amount, &target_metric } )
+    {
+      if ( player -> sim -> statistics_sketch )
+        sd -> use_sketch();
+      else
+        sd -> use_compact();
+    }
+  }
+
   if ( ! player -> is_enemy() && ( ! player -> is_pet() || player -> sim -> report_pets_separately ) )
   {
     resource_lost.resize( RESOURCE_MAX );
@@ -11193,6 +11221,24 @@ void player_collected_data_t::reserve_memory( const player_t& p )
     effective_theck_meloree_index.reserve( size );
     p.sim -> num_tanks++;
   }
+
+  // Timelines: reserve the longest expected fight, so adding to them does not reallocate
+  timespan_t max_length = timespan_t::from_seconds( p.sim -> expected_max_time() );
+  timeline_dmg.reserve( max_length );
+  timeline_dmg_taken.reserve( max_length );
+  timeline_healing_taken.reserve( max_length );
+  for ( auto& rtl : resource_timelines )
+    rtl.timeline.reserve( max_length );
+  for ( auto& stl : stat_timelines )
+    stl.timeline.reserve( max_length );
+  for ( auto tl : { &health_changes, &health_changes_tmi } )
+  {
+    if ( tl -> collect )
+    {
+      tl -> timeline.reserve( max_length );
+      tl -> timeline_normalized.reserve( max_length );
+    }
+  }
 }
 
 void player_collected_data_t::merge( const player_collected_data_t& other )
@@ -11650,6 +11696,10 @@ action_t* player_t::select_action( const action_priority_list_t& list )
     if ( a -> option.wait_on_ready == 1 )
       break;
 
+    // Cheap pre-filter before the (virtual, often deep) ready() call chain
+    if ( a -> cooldown_gated_ready && a -> cooldown_gates_down() )
+      continue;
+
     if ( a -> ready() )
     {
       // Execute variable operation, and continue processing
@@ -11691,6 +11741,229 @@ action_t* player_t::select_action( const action_priority_list_t& list )
   return 0;
 }
 
+// player_t::select_compiled_action =========================================
+
+// select_action( list ) through the compiled program of the list (apl_compiler). Lists the
+// compiler declines, and actors whose skill makes the choice random, use select_action().
+action_t* player_t::select_compiled_action( action_priority_list_t& list )
+{
+  apl_program_t& program = list.program;
+
+  if ( ! program.compiled( list ) )
+  {
+    program.compile( list );
+  }
+
+  if ( program.code.empty() || current.skill - current.skill_debuff != 1 )
+  {
+    return select_action( list );
+  }
+
+  if ( ! sim -> apl_compiler_verify )
+  {
+    return program.run( *this );
+  }
+
+  // Verify mode selects through the program first, undoes the target and variable changes its
+  // ready() checks made, and then selects through the tree, which stays authoritative. ready() is
+  // called twice, so rolls and starved procs in it happen twice.
+  std::vector<player_t*> targets;
+  targets.reserve( program.actions.size() );
+  for ( const action_t* a : program.actions )
+  {
+    targets.push_back( a -> target );
+  }
+
+  std::vector<double> values;
+  values.reserve( variables.size() );
+  for ( const action_variable_t* v : variables )
+  {
+    values.push_back( v -> current_value_ );
+  }
+
+  action_t* compiled_a = program.run( *this );
+
+  for ( size_t i = 0; i < program.actions.size(); ++i )
+  {
+    action_t* a = program.actions[ i ];
+    if ( a -> target != targets[ i ] )
+    {
+      a -> target = targets[ i ];
+      a -> target_cache.is_valid = false;
+    }
+  }
+
+  for ( size_t i = 0; i < variables.size(); ++i )
+  {
+    variables[ i ] -> current_value_ = values[ i ];
+  }
+
+  visited_apls_ = 0;
+  action_t* tree_a = select_action( list );
+
+  if ( compiled_a != tree_a && program.mismatches++ == 0 )
+  {
+    sim -> errorf( "Player %s action list %s compiled selection %s differs from tree selection %s at %.3f, iteration %d",
+                   name(), list.name_str.c_str(),
+                   compiled_a ? compiled_a -> signature_str.c_str() : "none",
+                   tree_a ? tree_a -> signature_str.c_str() : "none",
+                   sim -> current_time().total_seconds(), sim -> current_iteration );
+  }
+
+  return tree_a;
+}
+
+// apl_program_t::compile ===================================================
+
+bool apl_program_t::compile( const action_priority_list_t& root )
+{
+  clear();
+  source = &root;
+
+  // Lists in code order, and the position of their first instruction
+  std::vector<const action_priority_list_t*> lists( 1, &root );
+  std::vector<unsigned> entries;
+  std::vector<std::pair<size_t, const action_priority_list_t*>> calls;
+
+  for ( size_t l = 0; l < lists.size(); ++l )
+  {
+    const action_priority_list_t* list = lists[ l ];
+
+    // Random lists and lists the visited mask cannot track stay with select_action()
+    if ( list -> random == 1 || list -> player != root.player || list -> internal_id >= 64 )
+    {
+      code.clear();
+      actions.clear();
+      return false;
+    }
+
+    entries.push_back( static_cast<unsigned>( code.size() ) );
+
+    for ( action_t* a : list -> foreground_action_list )
+    {
+      instruction_t i;
+      i.op     = OP_ACTION;
+      i.jump   = 0;
+      i.mask   = 0;
+      i.action = a;
+
+      if ( a -> type == ACTION_VARIABLE )
+      {
+        i.op = OP_VARIABLE;
+      }
+      else if ( a -> type == ACTION_CALL )
+      {
+        const action_priority_list_t* called = static_cast<call_action_list_t*>( a ) -> alist;
+        if ( ! called )
+        {
+          code.clear();
+          actions.clear();
+          return false;
+        }
+
+        i.op   = OP_CALL;
+        i.mask = called -> internal_id_mask;
+        calls.push_back( std::make_pair( code.size(), called ) );
+        if ( range::find( lists, called ) == lists.end() )
+        {
+          lists.push_back( called );
+        }
+      }
+
+      code.push_back( i );
+      actions.push_back( a );
+    }
+
+    instruction_t ret;
+    ret.op     = OP_RETURN;
+    ret.jump   = 0;
+    ret.mask   = 0;
+    ret.action = nullptr;
+    code.push_back( ret );
+  }
+
+  for ( const auto& call : calls )
+  {
+    code[ call.first ].jump = entries[ std::distance( lists.begin(), range::find( lists, call.second ) ) ];
+  }
+
+  return true;
+}
+
+// apl_program_t::run =======================================================
+
+// Mirrors player_t::select_action() line by line. The visited list mask of each calling list is
+// kept on the return stack, a call into a list already on the stack is an infinite loop.
+action_t* apl_program_t::run( player_t& p ) const
+{
+  struct frame_t
+  {
+    unsigned ip;
+    uint64_t visited;
+  };
+
+  // Every list on the stack has a distinct internal id below 64
+  frame_t stack[ 64 ];
+  size_t depth = 0;
+  uint64_t visited = source -> internal_id_mask;
+  unsigned ip = 0;
+
+  for ( ;; )
+  {
+    const instruction_t& i = code[ ip++ ];
+    action_t* a = i.action;
+
+    if ( i.op != OP_RETURN )
+    {
+      if ( a -> background ) continue;
+
+      // wait_on_ready ends the list, as do infinite loops below
+      if ( a -> option.wait_on_ready != 1 )
+      {
+        if ( a -> cooldown_gated_ready && a -> cooldown_gates_down() )
+          continue;
+
+        if ( ! a -> ready() )
+          continue;
+
+        if ( i.op == OP_VARIABLE )
+        {
+          a -> execute();
+          continue;
+        }
+
+        if ( i.op == OP_ACTION )
+        {
+          if ( depth > 0 && a -> action_list )
+            a -> action_list -> used = true;
+          return a;
+        }
+
+        if ( ! ( visited & i.mask ) )
+        {
+          assert( depth < 64 );
+          stack[ depth ].ip = ip;
+          stack[ depth ].visited = visited;
+          ++depth;
+          visited |= i.mask;
+          ip = i.jump;
+          continue;
+        }
+
+        p.sim -> errorf( "%s action list in infinite loop", p.name() );
+        p.sim -> cancel();
+      }
+    }
+
+    if ( depth == 0 )
+      return nullptr;
+
+    --depth;
+    ip = stack[ depth ].ip;
+    visited = stack[ depth ].visited;
+  }
+}
+
 player_t* player_t::actor_by_name_str( const std::string& name ) const
 {
   // Check player pets first
@@ -11718,6 +11991,23 @@ player_t* player_t::actor_by_name_str( const std::string& name ) const
   return 0;
 }
 
+// player_t::expr_memo_slot =================================================
+
+unsigned player_t::expr_memo_slot( const std::string& key )
+{
+  auto it = expr_memo_slots.find( key );
+  if ( it != expr_memo_slots.end() )
+  {
+    return it -> second;
+  }
+
+  unsigned slot = static_cast<unsigned>( expr_memo.size() );
+  expr_memo.push_back( expr_memo_t{ 0, nullptr, 0 } );
+  expr_memo_slots[ key ] = slot;
+
+  return slot;
+}
+
 slot_e player_t::parent_item_slot( const item_t& item ) const
 {
   unsigned parent = dbc.parent_item( item.parsed.data.id );
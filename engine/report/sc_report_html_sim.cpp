@@ -441,6 +441,14 @@ void print_html_sim_summary( report::sc_html_stream& os, sim_t& sim )
       "</tr>\n",
       sim.event_mgr.total_events_processed );
 
+  os.format(
+      "<tr class=\"left\">\n"
+      "<th>Events Executed / Canceled:</th>\n"
+      "<td>%lu / %lu</td>\n"
+      "</tr>\n",
+      sim.event_mgr.total_events_executed,
+      sim.event_mgr.total_events_canceled );
+
   os.format(
       "<tr class=\"left\">\n"
       "<th>Max Event Queue:</th>\n"
@@ -573,6 +581,71 @@ void print_html_sim_summary( report::sc_html_stream& os, sim_t& sim )
      << "</div>\n\n";
 }
 
+// print_html_cpu_profile ===================================================
+
+void print_html_cpu_profile( report::sc_html_stream& os, const sim_t& sim )
+{
+  double total_time = 0;
+  for ( const auto& entry : sim.event_mgr.cpu_profile )
+  {
+    if ( entry.second.category == "Event" )
+    {
+      total_time += entry.second.stopwatch.current();
+    }
+  }
+
+  os << "<div id=\"cpu-profile\" class=\"section\">\n\n";
+  os << "<h2 class=\"toggle\">CPU Profile</h2>\n"
+     << "<div class=\"toggle-content hide\">\n";
+
+  os << "<table class=\"sc\">\n"
+     << "<tr>\n"
+     << "<th class=\"left small\">Category</th>\n"
+     << "<th class=\"left small\">Name</th>\n"
+     << "<th class=\"small\">Seconds</th>\n"
+     << "<th class=\"small\">Event%</th>\n"
+     << "<th class=\"small\">Calls</th>\n"
+     << "<th class=\"small\">usec/Call</th>\n"
+     << "</tr>\n";
+
+  int count = 0;
+  for ( auto entry : sim.event_mgr.sorted_cpu_profile() )
+  {
+    double t = entry->stopwatch.current();
+
+    os << "<tr";
+    if ( count++ & 1 )
+      os << " class=\"odd\"";
+    os << ">\n";
+
+    os.format(
+        "<td class=\"left small\">%s</td>\n"
+        "<td class=\"left small\">%s</td>\n"
+        "<td class=\"right small\">%.3f</td>\n"
+        "<td class=\"right small\">%.2f%%</td>\n"
+        "<td class=\"right small\">%" PRIu64 "</td>\n"
+        "<td class=\"right small\">%.3f</td>\n"
+        "</tr>\n",
+        entry->category.c_str(), util::encode_html( entry->name ).c_str(), t,
+        total_time > 0 ? t / total_time * 100.0 : 0.0, entry->count,
+        entry->count ? t / entry->count * 1e6 : 0.0 );
+  }
+
+  // closure
+  os << "</table>\n";
+
+  if ( sim.memoize_expressions )
+  {
+    uint64_t lookups = sim.event_mgr.expr_memo_hits + sim.event_mgr.expr_memo_evaluations;
+    os.format( "<p>Expression memo: %" PRIu64 " hits / %" PRIu64 " evaluations (%.2f%% hit rate)</p>\n",
+               sim.event_mgr.expr_memo_hits, sim.event_mgr.expr_memo_evaluations,
+               lookups ? 100.0 * sim.event_mgr.expr_memo_hits / lookups : 0.0 );
+  }
+  os << "<div class=\"clear\"></div>\n"
+     << "</div>\n"
+     << "</div>\n\n";
+}
+
 // print_html_raid_summary ==================================================
 
 void print_html_raid_summary( report::sc_html_stream& os, sim_t& sim )
@@ -1407,6 +1480,9 @@ void print_html_( report::sc_html_stream& os, sim_t& sim )
   if ( sim.report_raw_abilities )
     raw_ability_summary::print( os, sim );
 
+  if ( sim.event_mgr.monitor_cpu )
+    print_html_cpu_profile( os, sim );
+
   // Report Targets
   if ( sim.report_targets )
   {
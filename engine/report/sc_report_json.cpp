@@ -1603,6 +1603,25 @@ void to_json( JsonOutput root, const sim_t& sim )
     add_non_zero( stats_root, "total_heal", sim.total_heal );
     add_non_zero( stats_root, "total_absorb", sim.total_absorb );
 
+    if ( sim.event_mgr.monitor_cpu )
+    {
+      auto profile_arr = root[ "cpu_profile" ].make_array();
+      for ( const auto entry : sim.event_mgr.sorted_cpu_profile() )
+      {
+        auto node = profile_arr.add();
+        node[ "category" ] = entry -> category;
+        node[ "name" ] = entry -> name;
+        node[ "seconds" ] = entry -> stopwatch.current();
+        node[ "count" ] = entry -> count;
+      }
+
+      if ( sim.memoize_expressions )
+      {
+        root[ "expression_memo" ][ "hits" ] = sim.event_mgr.expr_memo_hits;
+        root[ "expression_memo" ][ "evaluations" ] = sim.event_mgr.expr_memo_evaluations;
+      }
+    }
+
     if ( sim.low_iteration_data.size() > 0 )
     {
       iteration_data_to_json( root[ "iteration_data" ][ "low" ], sim.low_iteration_data );
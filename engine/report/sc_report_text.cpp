@@ -766,9 +766,10 @@ void print_text_performance( FILE* file, sim_t* sim )
       "  RNG Engine    = %s%s\n"
       "  Iterations    = %d%s\n"
       "  TotalEvents   = %lu\n"
+      "  ExecEvents    = %lu\n"
+      "  CancelEvents  = %lu (%.3f%%)\n"
       "  MaxEventQueue = %lu\n"
 #ifdef EVENT_QUEUE_DEBUG
-      "  AllocEvents   = %u\n"
       "  EndInsert     = %u (%.3f%%)\n"
       "  MaxQueueDepth = %u\n"
       "  AvgQueueDepth = %.3f\n"
@@ -783,9 +784,14 @@ void print_text_performance( FILE* file, sim_t* sim )
       sim->iterations,
       sim -> threads > 1 ? iterations_str.str().c_str() : "",
       sim->event_mgr.total_events_processed,
+      sim->event_mgr.total_events_executed,
+      sim->event_mgr.total_events_canceled,
+      100.0 * sim->event_mgr.total_events_canceled /
+          std::max( uint64_t( 1 ), sim->event_mgr.total_events_executed +
+                                       sim->event_mgr.total_events_canceled ),
       sim->event_mgr.max_events_remaining,
 #ifdef EVENT_QUEUE_DEBUG
-      sim->event_mgr.n_allocated_events, sim->event_mgr.n_end_insert,
+      sim->event_mgr.n_end_insert,
       100.0 * static_cast<double>( sim->event_mgr.n_end_insert ) /
           sim->event_mgr.events_added,
       sim->event_mgr.max_queue_depth,
@@ -797,6 +803,31 @@ void print_text_performance( FILE* file, sim_t* sim )
       sim->elapsed_time,
       sim->iterations * sim->simulation_length.mean() / sim->elapsed_cpu,
       date_str, static_cast<double>( cur_time ) );
+
+  uint64_t total_requested = 0;
+  for ( auto n : sim->event_mgr.n_requested_events )
+  {
+    total_requested += n;
+  }
+
+  util::fprintf( file, "Event Allocation:\n" );
+  for ( unsigned i = 0; i <= event_manager_t::EVENT_SIZE_CLASSES; ++i )
+  {
+    if ( sim->event_mgr.n_requested_events[ i ] == 0 )
+    {
+      continue;
+    }
+
+    std::string block_str = i < event_manager_t::EVENT_SIZE_CLASSES
+                                ? util::to_string( event_manager_t::event_block_size( i ) )
+                                : "Oversize";
+    util::fprintf( file, "  %-13s = %" PRIu64 " requests (%.3f%%), %" PRIu64 " blocks\n",
+                   ( "Block " + block_str ).c_str(),
+                   sim->event_mgr.n_requested_events[ i ],
+                   100.0 * sim->event_mgr.n_requested_events[ i ] / total_requested,
+                   sim->event_mgr.n_allocated_events[ i ] );
+  }
+
 #ifdef EVENT_QUEUE_DEBUG
   double total_p = 0;
 
@@ -822,29 +853,6 @@ void print_text_performance( FILE* file, sim_t* sim )
   }
   util::fprintf( file, "Total: %.3f%% Samples: %llu\n", total_p,
                  sim->event_mgr.events_added );
-
-  util::fprintf( file, "\nEvent Queue Allocation:\n" );
-  double total_a = 0;
-  for ( size_t i = 0; i < sim->event_mgr.event_requested_size_count.size();
-        ++i )
-  {
-    if ( sim->event_mgr.event_requested_size_count[ i ] == 0 )
-    {
-      continue;
-    }
-
-    double p =
-        100.0 *
-        static_cast<double>( sim->event_mgr.event_requested_size_count[ i ] ) /
-        sim->event_mgr.n_requested_events;
-    util::fprintf( file, "Alloc-Size: %-4u Samples: %-7u (%.3f%%)\n", i,
-                   sim->event_mgr.event_requested_size_count[ i ], p );
-
-    total_a += p;
-  }
-
-  util::fprintf( file, "Total: %.3f%% Alloc Samples: %llu\n", total_p,
-                 sim->event_mgr.n_requested_events );
 #endif
 }
 
@@ -1120,6 +1128,40 @@ void print_text_monitor_cpu( FILE* file, sim_t* sim )
         p->event_stopwatch.current() / total_event_time * 100.0, p->name() );
   }
 #endif  // ACTOR_EVENT_BOOKKEEPING
+
+  if ( !sim->event_mgr.monitor_cpu )
+    return;
+
+  // Event entries cover all event processing, other categories are nested in
+  // events.
+  double total_profile_time = 0;
+  for ( const auto& entry : sim->event_mgr.cpu_profile )
+  {
+    if ( entry.second.category == "Event" )
+    {
+      total_profile_time += entry.second.stopwatch.current();
+    }
+  }
+
+  util::fprintf( file, "\nCPU Profile:\n" );
+  for ( auto entry : sim->event_mgr.sorted_cpu_profile() )
+  {
+    double t = entry->stopwatch.current();
+    util::fprintf( file,
+                   "%10.3fsec / %5.2f%% %12" PRIu64 " calls %9.3fusec/call : %-7s %s\n",
+                   t, total_profile_time > 0 ? t / total_profile_time * 100.0 : 0.0,
+                   entry->count, entry->count ? t / entry->count * 1e6 : 0.0,
+                   entry->category.c_str(), entry->name.c_str() );
+  }
+
+  if ( sim->memoize_expressions )
+  {
+    uint64_t lookups = sim->event_mgr.expr_memo_hits + sim->event_mgr.expr_memo_evaluations;
+    util::fprintf( file,
+                   "\nExpression Memo: %" PRIu64 " hits / %" PRIu64 " evaluations (%.2f%% hit rate)\n",
+                   sim->event_mgr.expr_memo_hits, sim->event_mgr.expr_memo_evaluations,
+                   lookups ? 100.0 * sim->event_mgr.expr_memo_hits / lookups : 0.0 );
+  }
 }
 
 // print_text_player ========================================================
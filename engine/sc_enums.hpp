@@ -1177,6 +1177,14 @@ enum action_energize_e
   ENERGIZE_PER_TICK
 };
 
+/// How iteration lengths are spread over [ 1 - vary_combat_length, 1 + vary_combat_length ]
+enum combat_length_sampling_e
+{
+  COMBAT_LENGTH_SWEEP = 0,   // Alternating sign, growing with sim progress
+  COMBAT_LENGTH_STRATIFIED,  // Van der Corput sequence over the global iteration number
+  COMBAT_LENGTH_ANTITHETIC   // Iteration pairs at u and 1 - u
+};
+
 // A simple enumeration to indicate a broad haste stat type for various things in the simulator
 enum haste_type_e
 {
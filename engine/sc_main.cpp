@@ -179,6 +179,16 @@ struct special_effect_initializer_t
   { unique_gear::unregister_special_effects(); }
 };
 
+// RAII-wrapper for the process-wide worker pool, shared by all (child) simulators
+struct thread_pool_initializer_t
+{
+  thread_pool_initializer_t( int n_workers )
+  { thread::init_pool( n_workers > 0 ? n_workers : 0 ); }
+
+  ~thread_pool_initializer_t()
+  { thread::shutdown_pool(); }
+};
+
 } // anonymous namespace ====================================================
 
 // sim_t::main ==============================================================
@@ -246,6 +256,8 @@ int sim_t::main( const std::vector<std::string>& args )
 
   if ( canceled ) return 1;
 
+  thread_pool_initializer_t thread_pool_init( threads - 1 );
+
   std::cout << std::endl;
 
   if ( spell_query )
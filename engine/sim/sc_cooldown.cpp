@@ -156,6 +156,8 @@ void cooldown_t::adjust_recharge_multiplier()
     return;
   }
 
+  sim.expr_generation++;
+
   double old_multiplier = recharge_multiplier;
   assert( action && "Only cooldowns with associated action can have their recharge multiplier adjusted.");
   recharge_multiplier = action -> recharge_multiplier();
@@ -204,6 +206,8 @@ void cooldown_t::adjust_recharge_multiplier()
 
 void cooldown_t::adjust( timespan_t amount, bool require_reaction )
 {
+  sim.expr_generation++;
+
   // Normal cooldown, just adjust as we see fit
   if ( charges == 1 )
   {
@@ -294,6 +298,8 @@ void cooldown_t::reset_init()
 
 void cooldown_t::reset( bool require_reaction, bool all_charges )
 {
+  sim.expr_generation++;
+
   bool was_down = down();
   ready = ready_init();
   if ( last_start > sim.current_time() )
@@ -331,6 +337,8 @@ void cooldown_t::start( action_t* a, timespan_t _override, timespan_t delay )
     return;
   }
 
+  sim.expr_generation++;
+
   reset_react = timespan_t::zero();
 
   action = a;
@@ -5,6 +5,92 @@
 
 #include "simulationcraft.hpp"
 
+namespace
+{
+// Hierarchical timing wheel layout: level 0 has 256 buckets of 1ms, levels
+// 1-4 have 64 buckets each. In total the wheel spans 2^32 milliseconds, events
+// further out are kept in a separate overflow bucket.
+const unsigned HWHEEL_LEVELS  = 5;
+const unsigned HWHEEL_L0_BITS = 8;
+const unsigned HWHEEL_LN_BITS = 6;
+const unsigned HWHEEL_BITS    = HWHEEL_L0_BITS + ( HWHEEL_LEVELS - 1 ) * HWHEEL_LN_BITS;
+const unsigned HWHEEL_BUCKETS = ( 1U << HWHEEL_L0_BITS ) + ( HWHEEL_LEVELS - 1 ) * ( 1U << HWHEEL_LN_BITS );
+
+unsigned hwheel_shift( unsigned level )
+{
+  return level == 0 ? 0 : HWHEEL_L0_BITS + ( level - 1 ) * HWHEEL_LN_BITS;
+}
+
+unsigned hwheel_mask( unsigned level )
+{
+  return level == 0 ? ( 1U << HWHEEL_L0_BITS ) - 1 : ( 1U << HWHEEL_LN_BITS ) - 1;
+}
+
+// Offset of the level's first bucket in event_manager_t::hwheel
+unsigned hwheel_offset( unsigned level )
+{
+  return level == 0 ? 0 : ( 1U << HWHEEL_L0_BITS ) + ( level - 1 ) * ( 1U << HWHEEL_LN_BITS );
+}
+
+// Offset of the level's first word in event_manager_t::hwheel_occupancy
+unsigned hwheel_word( unsigned level )
+{
+  return level == 0 ? 0 : ( 1U << HWHEEL_L0_BITS ) / 64 + ( level - 1 );
+}
+
+unsigned lowest_set_bit( uint64_t v )
+{
+  assert( v != 0 );
+#if defined( SC_GCC ) || defined( SC_CLANG )
+  return static_cast<unsigned>( __builtin_ctzll( v ) );
+#else
+  unsigned n = 0;
+  while ( !( v & 1 ) )
+  {
+    v >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+// Event blocks are carved out of contiguous per-size-class chunks. Each block
+// starts with a small header that records its size class, so a recycled event
+// finds its way back to the correct free list. Oversize blocks additionally
+// record their usable size. The header size keeps the event itself aligned the
+// same way as malloc'd memory.
+const std::size_t EVENT_BLOCK_HEADER = 16;
+const std::size_t EVENT_CHUNK_SIZE   = 16384;
+
+unsigned& block_size_class( event_t* e )
+{
+  return *reinterpret_cast<unsigned*>( reinterpret_cast<char*>( e ) - EVENT_BLOCK_HEADER );
+}
+
+std::size_t& block_capacity( event_t* e )
+{
+  return *reinterpret_cast<std::size_t*>( reinterpret_cast<char*>( e ) - sizeof( std::size_t ) );
+}
+
+// Heap order for event_manager_t::canceled_events, earliest time first
+bool later_event( const event_t* l, const event_t* r )
+{
+  return l->time > r->time;
+}
+
+void bucket_append( event_manager_t::wheel_bucket_t& b, event_t* e )
+{
+  e->next = nullptr;
+  e->prev = b.tail;
+  if ( b.tail )
+    b.tail->next = e;
+  else
+    b.head = e;
+  b.tail = e;
+}
+
+}  // unnamed namespace
+
 // ==========================================================================
 // Event
 // ==========================================================================
@@ -12,12 +98,14 @@
 event_t::event_t( sim_t& s, actor_t* a )
   : _sim( s ),
     next( nullptr ),
+    prev( nullptr ),
     time( timespan_t::zero() ),
     reschedule_time( timespan_t::zero() ),
     id( 0 ),
     canceled( false ),
     recycled( false ),
-    scheduled( false )
+    scheduled( false ),
+    queued( false )
 #if ACTOR_EVENT_BOOKKEEPING
     ,
     actor( a )
@@ -76,7 +164,16 @@ void event_t::cancel( event_t*& e )
 #endif
 
   e->canceled = true;
-  e           = nullptr;
+
+  // Events still in the queue are unlinked right away, and recycled once their
+  // scheduled time has passed. Events canceled during their own execution are
+  // recycled by the event manager.
+  if ( e->queued )
+  {
+    e->_sim.event_mgr.remove_event( e );
+  }
+
+  e = nullptr;
 }
 
 // ==========================================================================
@@ -90,24 +187,38 @@ event_manager_t::event_manager_t( sim_t* s )
     events_remaining( 0 ),
     events_processed( 0 ),
     total_events_processed( 0 ),
+    total_events_executed( 0 ),
+    total_events_canceled( 0 ),
     max_events_remaining( 0 ),
+    expr_memo_hits( 0 ),
+    expr_memo_evaluations( 0 ),
     timing_slice( 0 ),
     global_event_id( 1 ),  // start at 1, so we can identify event -> id == 0
                            // meaning a unscheduled event.
     timing_wheel(),
-    recycled_event_list( nullptr ),
+    recycled_event_list(),
+    chunk_cursor(),
+    chunk_end(),
+    event_chunks(),
     wheel_seconds( 0 ),
     wheel_size( 0 ),
     wheel_mask( 0 ),
     wheel_shift( 5 ),
     wheel_granularity( 0.0 ),
     wheel_time( timespan_t::zero() ),
+    allocated_events(),
+    canceled_events(),
+    n_requested_events(),
+    n_allocated_events(),
+    hierarchical_wheel( false ),
+    hwheel_time( 0 ),
+    hwheel(),
+    hwheel_occupancy(),
+    hwheel_overflow(),
     event_stopwatch( STOPWATCH_THREAD ),
 #ifdef EVENT_QUEUE_DEBUG
     monitor_cpu( false ),
     max_queue_depth( 0 ),
-    n_allocated_events( 0 ),
-    n_requested_events( 0 ),
     n_end_insert( 0 ),
     events_traversed( 0 ),
     events_added( 0 )
@@ -123,52 +234,93 @@ event_manager_t::event_manager_t( sim_t* s )
 
 event_manager_t::~event_manager_t()
 {
-  while ( recycled_event_list )
+  for ( auto chunk : event_chunks )
   {
-    event_t* e          = recycled_event_list;
-    recycled_event_list = e->next;
-    free( e );
+    free( chunk );
   }
 }
 
+// event_manager_t::event_block_size ========================================
+
+std::size_t event_manager_t::event_block_size( unsigned size_class )
+{
+  return std::size_t( 64 ) << size_class;
+}
+
 // event_manager_t::allocate_event ==========================================
 
 void* event_manager_t::allocate_event( const std::size_t size )
 {
-  static const std::size_t SIZE = util::next_power_of_two( 2 * sizeof( event_t ) );
-  assert( SIZE > size );
-  (void)size;
+  unsigned size_class = 0;
+  while ( size_class < EVENT_SIZE_CLASSES &&
+          event_block_size( size_class ) - EVENT_BLOCK_HEADER < size )
+  {
+    size_class++;
+  }
 
-  event_t* e = recycled_event_list;
-#ifdef EVENT_QUEUE_DEBUG
-  n_requested_events++;
-  if ( size >= event_requested_size_count.size() )
+  n_requested_events[ size_class ]++;
+
+  // Events larger than the largest size class are rare; give each its own
+  // heap block, and reuse recycled ones on a first fit basis.
+  if ( size_class == EVENT_SIZE_CLASSES )
   {
-    event_requested_size_count.resize( size + 1 );
+    for ( event_t** p = &recycled_event_list[ size_class ]; *p; p = &( ( *p )->next ) )
+    {
+      if ( block_capacity( *p ) >= size )
+      {
+        event_t* e = *p;
+        *p         = e->next;
+        return e;
+      }
+    }
+
+    char* block = static_cast<char*>( malloc( EVENT_BLOCK_HEADER + size ) );
+    if ( !block )
+    {
+      throw std::bad_alloc();
+    }
+
+    event_chunks.push_back( block );
+    event_t* e = reinterpret_cast<event_t*>( block + EVENT_BLOCK_HEADER );
+    block_size_class( e ) = size_class;
+    block_capacity( e )   = size;
+    n_allocated_events[ size_class ]++;
+    allocated_events.push_back( e );
+    return e;
   }
-  event_requested_size_count[ size ]++;
-#endif
+
+  event_t* e = recycled_event_list[ size_class ];
   if ( e )
   {
-    recycled_event_list = e->next;
+    recycled_event_list[ size_class ] = e->next;
+    return e;
   }
-  else
-  {
-    e = (event_t*)malloc( SIZE );
 
-    if ( !e )
+  // Carve a new block out of the size class chunk, allocating a new chunk if
+  // the current one is exhausted.
+  std::size_t block_size = event_block_size( size_class );
+  if ( static_cast<std::size_t>( chunk_end[ size_class ] - chunk_cursor[ size_class ] ) < block_size )
+  {
+    std::size_t chunk_size = std::max( EVENT_CHUNK_SIZE, block_size );
+    char* chunk = static_cast<char*>( malloc( chunk_size ) );
+    if ( !chunk )
     {
       throw std::bad_alloc();
     }
-    else
-    {
-#ifdef EVENT_QUEUE_DEBUG
-      n_allocated_events++;
-#endif
-      allocated_events.push_back( e );
-    }
+
+    event_chunks.push_back( chunk );
+    chunk_cursor[ size_class ] = chunk;
+    chunk_end[ size_class ]    = chunk + chunk_size;
   }
 
+  char* block = chunk_cursor[ size_class ];
+  chunk_cursor[ size_class ] += block_size;
+
+  e = reinterpret_cast<event_t*>( block + EVENT_BLOCK_HEADER );
+  block_size_class( e ) = size_class;
+  n_allocated_events[ size_class ]++;
+  allocated_events.push_back( e );
+
   return e;
 }
 
@@ -176,10 +328,11 @@ void* event_manager_t::allocate_event( const std::size_t size )
 
 void event_manager_t::recycle_event( event_t* e )
 {
+  unsigned size_class = block_size_class( e );
   e->~event_t();
-  e->recycled         = true;
-  e->next             = recycled_event_list;
-  recycled_event_list = e;
+  e->recycled                       = true;
+  e->next                           = recycled_event_list[ size_class ];
+  recycled_event_list[ size_class ] = e;
 }
 
 // event_manager_t::add_event ===============================================
@@ -191,6 +344,10 @@ void event_manager_t::add_event( event_t* e, timespan_t delta_time )
   if ( delta_time < timespan_t::zero() )
     delta_time = timespan_t::zero();
 
+  // Events beyond the default wheel's horizon are parked and rescheduled. The
+  // hierarchical wheel has no such horizon, but parks them the same way: events
+  // of equal time execute in the order they were (re)inserted, so both queues
+  // execute events in exactly the same order.
   if ( delta_time > wheel_time )
   {
     e->time = current_time + wheel_time - timespan_t::from_seconds( 1 );
@@ -202,46 +359,60 @@ void event_manager_t::add_event( event_t* e, timespan_t delta_time )
     e->reschedule_time = timespan_t::zero();
   }
 
-  // Determine the timing wheel position to which the event will belong
-  // Only valid for integer based timespan_t
-  uint32_t slice = static_cast<uint32_t>(
-      ( e->time.total_millis() >> wheel_shift ) & wheel_mask );
-
-  // Insert event into the event list at the appropriate time
-  event_t** prev = &( timing_wheel[ slice ] );
+  if ( hierarchical_wheel )
+  {
+    hwheel_insert( e );
+  }
+  else
+  {
+    // Determine the timing wheel position to which the event will belong
+    // Only valid for integer based timespan_t
+    uint32_t slice = static_cast<uint32_t>(
+        ( e->time.total_millis() >> wheel_shift ) & wheel_mask );
+
+    // Insert event into the event list at the appropriate time
+    event_t** prev = &( timing_wheel[ slice ] );
+    event_t* prev_event = nullptr;
 #ifdef EVENT_QUEUE_DEBUG
-  unsigned traversed = 0;
+    unsigned traversed = 0;
 #endif
 
-  while ( ( *prev ) &&
-          ( *prev )->time <= e->time )  // Find position in the list
-  {
-    prev = &( ( *prev )->next );
+    while ( ( *prev ) &&
+            ( *prev )->time <= e->time )  // Find position in the list
+    {
+      prev_event = *prev;
+      prev = &( ( *prev )->next );
 #ifdef EVENT_QUEUE_DEBUG
-    traversed++;
+      traversed++;
 #endif
-  }
+    }
 #ifdef EVENT_QUEUE_DEBUG
-  events_added++;
-  events_traversed += traversed;
-  if ( traversed > max_queue_depth )
-  {
-    max_queue_depth = traversed;
-  }
-  if ( traversed >= event_queue_depth_samples.size() )
-  {
-    event_queue_depth_samples.resize( traversed + 1 );
-  }
-  event_queue_depth_samples[ traversed ].first++;
-  if ( !*prev && traversed )
-  {
-    event_queue_depth_samples[ traversed ].second++;
-    n_end_insert++;
-  }
+    events_added++;
+    events_traversed += traversed;
+    if ( traversed > max_queue_depth )
+    {
+      max_queue_depth = traversed;
+    }
+    if ( traversed >= event_queue_depth_samples.size() )
+    {
+      event_queue_depth_samples.resize( traversed + 1 );
+    }
+    event_queue_depth_samples[ traversed ].first++;
+    if ( !*prev && traversed )
+    {
+      event_queue_depth_samples[ traversed ].second++;
+      n_end_insert++;
+    }
 #endif
-  // insert event
-  e->next = *prev;
-  *prev   = e;
+    // insert event
+    e->next = *prev;
+    e->prev = prev_event;
+    if ( e->next )
+      e->next->prev = e;
+    *prev   = e;
+  }
+
+  e->queued = true;
 
   if ( ++events_remaining > max_events_remaining )
     max_events_remaining = events_remaining;
@@ -261,6 +432,77 @@ void event_manager_t::add_event( event_t* e, timespan_t delta_time )
 #endif
 }
 
+// event_manager_t::remove_event ============================================
+
+/// Unlink a canceled event from the queue. The event memory is not recycled
+/// until the event's scheduled time, as it was when canceled events stayed in
+/// the queue, so other pointers still referring to the event (e.g. a second
+/// cancel through an alias) cannot touch an unrelated, reallocated event.
+void event_manager_t::remove_event( event_t* e )
+{
+  assert( e->queued );
+
+  if ( hierarchical_wheel )
+  {
+    uint64_t* occupancy = nullptr;
+    uint64_t bit = 0;
+    wheel_bucket_t& bucket = hwheel_bucket( e, occupancy, bit );
+
+    if ( e->prev )
+      e->prev->next = e->next;
+    else
+      bucket.head = e->next;
+
+    if ( e->next )
+      e->next->prev = e->prev;
+    else
+      bucket.tail = e->prev;
+
+    if ( !bucket.head && occupancy )
+      *occupancy &= ~bit;
+  }
+  else
+  {
+    if ( e->prev )
+    {
+      e->prev->next = e->next;
+    }
+    else
+    {
+      uint32_t slice = static_cast<uint32_t>(
+          ( e->time.total_millis() >> wheel_shift ) & wheel_mask );
+      timing_wheel[ slice ] = e->next;
+    }
+
+    if ( e->next )
+      e->next->prev = e->prev;
+  }
+
+  if ( sim->debug )
+    sim->out_debug.printf( "Canceled event: %s id=%d", e->name(), e->id );
+
+  e->queued = false;
+  events_remaining--;
+  total_events_canceled++;
+
+  canceled_events.push_back( e );
+  std::push_heap( canceled_events.begin(), canceled_events.end(), later_event );
+}
+
+// event_manager_t::release_canceled_events =================================
+
+/// Recycle canceled events whose scheduled time has passed.
+void event_manager_t::release_canceled_events()
+{
+  while ( !canceled_events.empty() && canceled_events.front()->time <= current_time )
+  {
+    event_t* e = canceled_events.front();
+    std::pop_heap( canceled_events.begin(), canceled_events.end(), later_event );
+    canceled_events.pop_back();
+    recycle_event( e );
+  }
+}
+
 // event_manager_t::reschedule_event ========================================
 
 void event_manager_t::reschedule_event( event_t* e )
@@ -279,8 +521,14 @@ bool event_manager_t::execute()
   {
     current_time = e->time;
 
+    if ( !canceled_events.empty() )
+      release_canceled_events();
+
+    // Canceled events are removed from the queue when they are canceled
+    assert( !e->canceled );
+
 #if ACTOR_EVENT_BOOKKEEPING
-    if ( sim->debug && e->actor && !e->canceled )
+    if ( sim->debug && e->actor )
     {
       // Perform actor event bookkeeping first
       e->actor->event_counter--;
@@ -295,12 +543,7 @@ bool event_manager_t::execute()
     }
 #endif
 
-    if ( e->canceled )
-    {
-      if ( sim->debug )
-        sim->out_debug.printf( "Canceled event: %s", e->name() );
-    }
-    else if ( e->reschedule_time > e->time )
+    if ( e->reschedule_time > e->time )
     {
       reschedule_event( e );
       continue;
@@ -310,6 +553,9 @@ bool event_manager_t::execute()
       if ( sim->debug )
         sim->out_debug.printf( "Executing event: %s", e->name() );
 
+      // Nothing memoized before this event is known to still hold
+      sim->expr_generation++;
+
       if ( monitor_cpu )
       {
 #if ACTOR_EVENT_BOOKKEEPING
@@ -319,14 +565,25 @@ bool event_manager_t::execute()
 
         stopwatch_t& sw = event_stopwatch;
 #endif
+        cpu_profile_t*& entry = event_profile[ e->name() ];
+        if ( !entry )
+        {
+          entry = &profile( "Event", e->name() );
+        }
+
         sw.mark();
-        e->execute();
+        {
+          cpu_profile_scope_t event_profile_scope( entry );
+          e->execute();
+        }
         sw.accumulate();
       }
       else
       {
         e->execute();
       }
+
+      total_events_executed++;
     }
 
     recycle_event( e );
@@ -362,13 +619,19 @@ void event_manager_t::flush()
   {
     if ( e->recycled )
       continue;
+    e->queued = false;  // The whole timing wheel is cleared below
     event_t* null_e = e;  // necessary evil
     event_t::cancel( null_e );
     recycle_event( e );
   }
+  canceled_events.clear();
 
   // Clear Timing Wheel
   timing_wheel.assign( timing_wheel.size(), nullptr );
+
+  hwheel.assign( hwheel.size(), wheel_bucket_t() );
+  hwheel_occupancy.fill( 0 );
+  hwheel_overflow = wheel_bucket_t();
 }
 
 // event_manager_t::init ====================================================
@@ -400,6 +663,11 @@ void event_manager_t::init()
   // The timing wheel represents an array of event lists: Each time slice has an
   // event list.
   timing_wheel.resize( wheel_size );
+
+  if ( hierarchical_wheel )
+  {
+    hwheel.resize( HWHEEL_BUCKETS );
+  }
 }
 
 // event_manager_t::next_event ==============================================
@@ -409,6 +677,15 @@ event_t* event_manager_t::next_event()
   if ( events_remaining == 0 )
     return nullptr;
 
+  if ( hierarchical_wheel )
+  {
+    event_t* e = hwheel_next_event();
+    e->queued = false;
+    events_remaining--;
+    events_processed++;
+    return e;
+  }
+
   while ( true )
   {
     event_t*& event_list = timing_wheel[ timing_slice ];
@@ -416,6 +693,9 @@ event_t* event_manager_t::next_event()
     {
       event_t* e = event_list;
       event_list = e->next;
+      if ( event_list )
+        event_list->prev = nullptr;
+      e->queued = false;
       events_remaining--;
       events_processed++;
       return e;
@@ -432,6 +712,142 @@ event_t* event_manager_t::next_event()
   return nullptr;
 }
 
+// event_manager_t::hwheel_bucket ===========================================
+
+/// Bucket the event belongs to at the current wheel time, along with its
+/// occupancy bit. The overflow bucket has no occupancy bit.
+event_manager_t::wheel_bucket_t& event_manager_t::hwheel_bucket( const event_t* e,
+                                                                 uint64_t*& occupancy,
+                                                                 uint64_t& bit )
+{
+  uint64_t t = static_cast<uint64_t>( e->time.total_millis() );
+  assert( t >= hwheel_time );
+
+  // The level is determined by the highest bit group in which the event time
+  // differs from the wheel time. Events within the current 1ms-bucket span go
+  // directly to level 0.
+  uint64_t diff = t ^ hwheel_time;
+  if ( diff >> HWHEEL_BITS )
+  {
+    occupancy = nullptr;
+    return hwheel_overflow;
+  }
+
+  unsigned level = HWHEEL_LEVELS - 1;
+  while ( level > 0 && !( diff >> hwheel_shift( level ) ) )
+  {
+    level--;
+  }
+
+  unsigned index = static_cast<unsigned>( t >> hwheel_shift( level ) ) & hwheel_mask( level );
+  occupancy = &hwheel_occupancy[ hwheel_word( level ) + index / 64 ];
+  bit = uint64_t( 1 ) << ( index % 64 );
+  return hwheel[ hwheel_offset( level ) + index ];
+}
+
+// event_manager_t::hwheel_insert ===========================================
+
+void event_manager_t::hwheel_insert( event_t* e )
+{
+  uint64_t* occupancy = nullptr;
+  uint64_t bit = 0;
+  bucket_append( hwheel_bucket( e, occupancy, bit ), e );
+  if ( occupancy )
+    *occupancy |= bit;
+}
+
+// event_manager_t::hwheel_cascade ==========================================
+
+/// Redistribute the events of a higher level bucket to lower levels. Events
+/// keep their relative order, so FIFO ordering of equal timestamps holds.
+void event_manager_t::hwheel_cascade( unsigned level, unsigned index )
+{
+  wheel_bucket_t& bucket = hwheel[ hwheel_offset( level ) + index ];
+  event_t* e = bucket.head;
+  bucket = wheel_bucket_t();
+  hwheel_occupancy[ hwheel_word( level ) + index / 64 ] &= ~( uint64_t( 1 ) << ( index % 64 ) );
+
+  while ( e )
+  {
+    event_t* next = e->next;
+    hwheel_insert( e );
+    e = next;
+  }
+}
+
+// event_manager_t::hwheel_next_event =======================================
+
+event_t* event_manager_t::hwheel_next_event()
+{
+  while ( true )
+  {
+    // Next occupied 1ms bucket within the current level 0 span
+    unsigned index = static_cast<unsigned>( hwheel_time ) & hwheel_mask( 0 );
+    for ( unsigned word = index / 64; word < ( 1U << HWHEEL_L0_BITS ) / 64; ++word )
+    {
+      uint64_t bits = hwheel_occupancy[ word ];
+      if ( word == index / 64 )
+        bits &= ~uint64_t( 0 ) << ( index % 64 );
+      if ( !bits )
+        continue;
+
+      unsigned slot = word * 64 + lowest_set_bit( bits );
+      wheel_bucket_t& bucket = hwheel[ slot ];
+      event_t* e = bucket.head;
+      bucket.head = e->next;
+      if ( bucket.head )
+      {
+        bucket.head->prev = nullptr;
+      }
+      else
+      {
+        bucket.tail = nullptr;
+        hwheel_occupancy[ word ] &= ~( uint64_t( 1 ) << ( slot % 64 ) );
+      }
+
+      hwheel_time = ( hwheel_time & ~uint64_t( hwheel_mask( 0 ) ) ) | slot;
+      return e;
+    }
+
+    // Level 0 span is exhausted, jump directly to the next occupied bucket on
+    // the lowest possible higher level and cascade it down.
+    bool cascaded = false;
+    for ( unsigned level = 1; level < HWHEEL_LEVELS && !cascaded; ++level )
+    {
+      unsigned shift = hwheel_shift( level );
+      unsigned next  = ( static_cast<unsigned>( hwheel_time >> shift ) & hwheel_mask( level ) ) + 1;
+      if ( next > hwheel_mask( level ) )
+        continue;
+
+      uint64_t bits = hwheel_occupancy[ hwheel_word( level ) ] & ( ~uint64_t( 0 ) << next );
+      if ( !bits )
+        continue;
+
+      unsigned slot = lowest_set_bit( bits );
+      uint64_t span_mask = ( uint64_t( hwheel_mask( level ) ) << shift ) | ( ( uint64_t( 1 ) << shift ) - 1 );
+      hwheel_time = ( hwheel_time & ~span_mask ) | ( uint64_t( slot ) << shift );
+      hwheel_cascade( level, slot );
+      cascaded = true;
+    }
+
+    if ( cascaded )
+      continue;
+
+    // Whole wheel is empty, advance to the next wheel revolution and
+    // redistribute the overflow bucket.
+    assert( hwheel_overflow.head );
+    hwheel_time = ( ( hwheel_time >> HWHEEL_BITS ) + 1 ) << HWHEEL_BITS;
+    event_t* e = hwheel_overflow.head;
+    hwheel_overflow = wheel_bucket_t();
+    while ( e )
+    {
+      event_t* next = e->next;
+      hwheel_insert( e );
+      e = next;
+    }
+  }
+}
+
 // event_manager_t::reset ===================================================
 
 void event_manager_t::reset()
@@ -439,6 +855,7 @@ void event_manager_t::reset()
   events_remaining = 0;
   events_processed = 0;
   timing_slice     = 0;
+  hwheel_time      = 0;
   global_event_id  = 0;
   canceled         = false;
   current_time     = timespan_t::zero();
@@ -451,12 +868,24 @@ void event_manager_t::merge( event_manager_t& other )
   max_events_remaining =
       std::max( max_events_remaining, other.max_events_remaining );
   total_events_processed += other.total_events_processed;
+  total_events_executed += other.total_events_executed;
+  total_events_canceled += other.total_events_canceled;
+  expr_memo_hits += other.expr_memo_hits;
+  expr_memo_evaluations += other.expr_memo_evaluations;
+  for ( const auto& entry : other.cpu_profile )
+  {
+    cpu_profile_t& p = profile( entry.second.category, entry.second.name );
+    p.merge( entry.second );
+  }
+  for ( unsigned i = 0; i <= EVENT_SIZE_CLASSES; ++i )
+  {
+    n_requested_events[ i ] += other.n_requested_events[ i ];
+    n_allocated_events[ i ] += other.n_allocated_events[ i ];
+  }
 #ifdef EVENT_QUEUE_DEBUG
   events_traversed += other.events_traversed;
   events_added += other.events_added;
-  n_allocated_events += other.n_allocated_events;
   n_end_insert += other.n_end_insert;
-  n_requested_events += other.n_requested_events;
   if ( other.max_queue_depth > max_queue_depth )
   {
     max_queue_depth = other.max_queue_depth;
@@ -475,10 +904,210 @@ void event_manager_t::merge( event_manager_t& other )
     event_queue_depth_samples[ i ].second +=
         other.event_queue_depth_samples[ i ].second;
   }
-  for ( size_t i = 0; i < other.event_requested_size_count.size(); ++i )
+#endif
+}
+
+// event_manager_t::profile =================================================
+
+/// Profile entry of a category and name, created on first use
+cpu_profile_t& event_manager_t::profile( const std::string& category,
+                                         const std::string& name )
+{
+  cpu_profile_t& entry = cpu_profile[ category + ":" + name ];
+  if ( entry.category.empty() )
   {
-    event_requested_size_count[ i ] += other.event_requested_size_count[ i ];
+    entry.category = category;
+    entry.name     = name;
   }
 
-#endif
+  return entry;
 }
+
+// event_manager_t::sorted_cpu_profile ======================================
+
+/// Profile entries ordered by descending cpu time
+std::vector<const cpu_profile_t*> event_manager_t::sorted_cpu_profile() const
+{
+  std::vector<const cpu_profile_t*> entries;
+  for ( const auto& entry : cpu_profile )
+  {
+    entries.push_back( &entry.second );
+  }
+
+  range::sort( entries, []( const cpu_profile_t* l, const cpu_profile_t* r ) {
+    return l->stopwatch.current() > r->stopwatch.current();
+  } );
+
+  return entries;
+}
+
+#ifdef UNIT_TEST
+
+#include <random>
+
+namespace
+{
+// Differential check of the hierarchical timing wheel against the default
+// timing wheel. The same pseudo-random workload runs on both queues; the
+// events it schedules, cancels and reschedules only depend on the order in
+// which events execute, so both queues must produce identical traces of
+// ( event, execution time ).
+
+struct queue_test_event_t;
+
+struct queue_test_t
+{
+  std::mt19937 rng;
+  unsigned next_tag;
+  unsigned budget;
+  std::vector<queue_test_event_t*> pending;
+  std::vector<std::pair<unsigned, timespan_t::native_t>> trace;
+
+  queue_test_t( unsigned seed, unsigned n_events ) :
+    rng( seed ), next_tag( 0 ), budget( n_events ), pending(), trace()
+  { }
+
+  // Delays on all wheel levels. Delays beyond the default wheel's horizon
+  // (1024 seconds) are parked and rescheduled by both queues.
+  timespan_t delay()
+  {
+    switch ( rng() % 8 )
+    {
+      case 0:
+      case 1:
+        return timespan_t::zero();
+      case 2:
+      case 3:
+        return timespan_t::from_millis( rng() % ( 1U << 8 ) );
+      case 4:
+        return timespan_t::from_millis( rng() % ( 1U << 14 ) );
+      case 5:
+        return timespan_t::from_millis( rng() % ( 1U << 20 ) );
+      default:
+        return timespan_t::from_millis( rng() % ( 1U << 26 ) );
+    }
+  }
+
+  void remove( queue_test_event_t* e );
+
+  void schedule( sim_t& sim, timespan_t delay, unsigned burst = 0 );
+};
+
+struct queue_test_event_t : public event_t
+{
+  queue_test_t* test;
+  unsigned tag;
+  unsigned burst; // Events scheduled on execution, anchors can't be canceled
+  size_t slot;    // Position in queue_test_t::pending
+
+  queue_test_event_t( sim_t& s, queue_test_t* t, timespan_t delay, unsigned b ) :
+    event_t( s, delay ), test( t ), tag( t->next_tag++ ), burst( b ), slot( t->pending.size() )
+  {
+    test->pending.push_back( this );
+  }
+
+  const char* name() const override
+  { return "queue_test"; }
+
+  void execute() override
+  {
+    test->remove( this );
+    test->trace.push_back( std::make_pair( tag, sim().event_mgr.current_time.total_millis() ) );
+
+    test->budget += burst;
+    for ( unsigned n = burst ? 64 : test->rng() % 4; n > 0; --n )
+    {
+      test->schedule( sim(), test->delay() );
+    }
+
+    // Cancel or reschedule pending events, which may be anywhere in the
+    // wheel, including higher level and overflow buckets about to be cascaded
+    // down.
+    if ( !test->pending.empty() && test->rng() % 3 == 0 )
+    {
+      queue_test_event_t* e = test->pending[ test->rng() % test->pending.size() ];
+      if ( e->burst )
+        return;
+
+      if ( test->rng() % 2 )
+      {
+        test->remove( e );
+        event_t::cancel( e );
+      }
+      else
+      {
+        e->reschedule( e->remains() + test->delay() );
+      }
+    }
+  }
+};
+
+void queue_test_t::remove( queue_test_event_t* e )
+{
+  pending[ e->slot ] = pending.back();
+  pending[ e->slot ]->slot = e->slot;
+  pending.pop_back();
+}
+
+void queue_test_t::schedule( sim_t& sim, timespan_t delay, unsigned burst )
+{
+  if ( budget == 0 && burst == 0 )
+    return;
+  if ( burst == 0 )
+    budget--;
+  make_event<queue_test_event_t>( sim, sim, this, delay, burst );
+}
+
+std::vector<std::pair<unsigned, timespan_t::native_t>> run_queue_test( bool hierarchical, unsigned seed,
+                                                                      unsigned n_events )
+{
+  sim_t sim;
+  sim.event_mgr.hierarchical_wheel = hierarchical;
+  sim.event_mgr.init();
+
+  queue_test_t test( seed, n_events );
+  for ( unsigned i = 0; i < 64; ++i )
+  {
+    test.schedule( sim, test.delay() );
+  }
+
+  // Bursts of activity right before, and far beyond, the end of the top
+  // level's span (2^32 ms). Events of the first burst are scheduled across
+  // the span boundary into the overflow bucket, and canceled from it.
+  const uint64_t span = uint64_t( 1 ) << 32;
+  test.schedule( sim, timespan_t::from_millis( span - ( 1U << 24 ) ), n_events );
+  test.schedule( sim, timespan_t::from_millis( 2 * span + ( 1U << 30 ) ), n_events );
+
+  sim.event_mgr.execute();
+  assert( test.pending.empty() );
+
+  return test.trace;
+}
+}
+
+int main( int argc, char** argv )
+{
+  unsigned n_runs   = argc > 1 ? static_cast<unsigned>( atoi( argv[ 1 ] ) ) : 5;
+  unsigned n_events = argc > 2 ? static_cast<unsigned>( atoi( argv[ 2 ] ) ) : 50000;
+  unsigned failures = 0;
+
+  for ( unsigned seed = 1; seed <= n_runs; ++seed )
+  {
+    auto wheel        = run_queue_test( false, seed, n_events );
+    auto hierarchical = run_queue_test( true, seed, n_events );
+
+    auto it = std::mismatch( wheel.begin(), wheel.end(), hierarchical.begin(), hierarchical.end() );
+    if ( it.first != wheel.end() || it.second != hierarchical.end() )
+    {
+      failures++;
+      printf( "seed %u: traces differ at event %u of %u/%u\n", seed,
+              static_cast<unsigned>( it.first - wheel.begin() ), static_cast<unsigned>( wheel.size() ),
+              static_cast<unsigned>( hierarchical.size() ) );
+    }
+  }
+
+  printf( "event queue: %u of %u runs differ\n", failures, n_runs );
+  return failures > 0;
+}
+
+#endif // UNIT_TEST
@@ -15,23 +15,45 @@ namespace
 const bool EXPRESSION_DEBUG = false;
 // Unary Operators ==========================================================
 
-template <class F>
-class expr_unary_t : public expr_t
+class unary_base_t : public expr_t
 {
+public:
   expr_t* input;
 
-public:
-  expr_unary_t( const std::string& n, token_e o, expr_t* i )
+  unary_base_t( const std::string& n, token_e o, expr_t* i )
     : expr_t( n, o ), input( i )
   {
     assert( input );
   }
 
-  ~expr_unary_t()
+  ~unary_base_t()
   {
     delete input;
   }
 
+  expr_t* optimize( int spacing ) override  // override
+  {
+    input = input->optimize( spacing + 2 );
+    double v;
+    if ( !input->is_constant( &v ) )
+      return this;
+
+    std::string n = std::string( "const_unary('" ) + input->name() + "')";
+    double result = evaluate();
+    delete this;
+    return new const_expr_t( n, result );
+  }
+};
+
+template <class F>
+class expr_unary_t : public unary_base_t
+{
+public:
+  expr_unary_t( const std::string& n, token_e o, expr_t* i )
+    : unary_base_t( n, o, i )
+  {
+  }
+
   double evaluate() override  // override
   {
     return F()( input->eval() );
@@ -88,14 +110,20 @@ expr_t* select_unary( const std::string& name, token_e op, expr_t* input )
 
 // Binary Operators =========================================================
 
+expr_t* fold_binary( const std::string& name, token_e op, expr_t* left,
+                     expr_t* right );
+
 class binary_base_t : public expr_t
 {
 public:
   expr_t* left;
   expr_t* right;
+  // Expected number of leaf evaluations, measured by the analyzing logical
+  // operators. Negative when unknown.
+  double cost;
 
   binary_base_t( const std::string& n, token_e o, expr_t* l, expr_t* r )
-    : expr_t( n, o ), left( l ), right( r )
+    : expr_t( n, o ), left( l ), right( r ), cost( -1 )
   {
     assert( left );
     assert( right );
@@ -106,6 +134,27 @@ public:
     delete left;
     delete right;
   }
+
+  expr_t* optimize( int spacing ) override  // override
+  {
+    left  = left->optimize( spacing + 2 );
+    right = right->optimize( spacing + 2 );
+    double v;
+    bool left_constant  = left->is_constant( &v );
+    bool right_constant = right->is_constant( &v );
+    bool logical = op_ == TOK_AND || op_ == TOK_OR || op_ == TOK_XOR;
+    if ( !( left_constant && right_constant ) &&
+         !( logical && ( left_constant || right_constant ) ) )
+      return this;
+
+    expr_t* l     = left;
+    expr_t* r     = right;
+    std::string n = name();
+    token_e o     = op_;
+    left = right = nullptr;
+    delete this;
+    return fold_binary( n, o, l, r );
+  }
 };
 
 class logical_and_t : public binary_base_t
@@ -205,6 +254,152 @@ expr_t* select_binary( const std::string& name, token_e op, expr_t* left,
   }
 }
 
+// Operator nodes that already evaluate to exactly 0 or 1
+bool is_truth_value( expr_t* node )
+{
+  if ( dynamic_cast<unary_base_t*>( node ) )
+    return node->op_ == TOK_NOT;
+
+  if ( dynamic_cast<binary_base_t*>( node ) )
+  {
+    switch ( node->op_ )
+    {
+      case TOK_AND:
+      case TOK_OR:
+      case TOK_XOR:
+      case TOK_EQ:
+      case TOK_NOTEQ:
+      case TOK_LT:
+      case TOK_LTEQ:
+      case TOK_GT:
+      case TOK_GTEQ:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  return false;
+}
+
+// Logical operators yield 0 or 1, so an operand that replaces one has to be
+// normalized unless it already is a truth value.
+expr_t* as_truth_value( const std::string& name, expr_t* node )
+{
+  if ( is_truth_value( node ) )
+    return node;
+
+  return select_unary( name, TOK_NOT, select_unary( name, TOK_NOT, node ) );
+}
+
+// Expected number of leaf evaluations of an optimized expression
+double expected_cost( expr_t* node )
+{
+  if ( dynamic_cast<const_expr_t*>( node ) )
+    return 0;
+
+  if ( unary_base_t* u = dynamic_cast<unary_base_t*>( node ) )
+    return expected_cost( u->input );
+
+  if ( binary_base_t* b = dynamic_cast<binary_base_t*>( node ) )
+    return b->cost >= 0 ? b->cost
+                        : expected_cost( b->left ) + expected_cost( b->right );
+
+  return 1;
+}
+
+// Constant folding and dead branch removal for binary operators. Takes
+// ownership of the operands.
+expr_t* fold_binary( const std::string& name, token_e op, expr_t* left,
+                     expr_t* right )
+{
+  double v;
+  bool left_constant  = left->is_constant( &v );
+  bool right_constant = right->is_constant( &v );
+  // Constants are evaluated, is_constant() does not always report the value
+  double left_value  = left_constant ? left->eval() : 0;
+  double right_value = right_constant ? right->eval() : 0;
+
+  if ( left_constant && right_constant )
+  {
+    expr_t* e     = select_binary( name, op, left, right );
+    double result = e->eval();
+    delete e;
+    return new const_expr_t( name, result );
+  }
+
+  if ( !left_constant && !right_constant )
+    return select_binary( name, op, left, right );
+
+  expr_t* constant = left_constant ? left : right;
+  expr_t* other    = left_constant ? right : left;
+  bool truth       = ( left_constant ? left_value : right_value ) != 0;
+
+  switch ( op )
+  {
+    case TOK_AND:
+      delete constant;
+      if ( !truth )
+      {
+        delete other;
+        return new const_expr_t( name, 0 );
+      }
+      return as_truth_value( name, other );
+    case TOK_OR:
+      delete constant;
+      if ( truth )
+      {
+        delete other;
+        return new const_expr_t( name, 1 );
+      }
+      return as_truth_value( name, other );
+    case TOK_XOR:
+      delete constant;
+      return truth ? select_unary( name, TOK_NOT, other )
+                   : as_truth_value( name, other );
+    default:
+      return select_binary( name, op, left, right );
+  }
+}
+
+// Build an and/or node from analyzed operands, evaluating first the operand
+// that decides the result (false for and, true for or) most often per leaf
+// evaluation. Ties keep the written order.
+expr_t* order_logical( const std::string& name, token_e op, expr_t* left,
+                       expr_t* right, uint64_t left_decisive,
+                       uint64_t right_decisive, uint64_t samples )
+{
+  double v;
+  if ( left->is_constant( &v ) || right->is_constant( &v ) )
+    return fold_binary( name, op, left, right );
+
+  double left_cost  = expected_cost( left );
+  double right_cost = expected_cost( right );
+  double left_p     = 0;
+  double right_p    = 0;
+  if ( samples > 0 )
+  {
+    left_p  = static_cast<double>( left_decisive ) / samples;
+    right_p = static_cast<double>( right_decisive ) / samples;
+
+    // cost / p ascending, written without division for p = 0
+    if ( right_cost * left_p < left_cost * right_p )
+    {
+      if ( EXPRESSION_DEBUG )
+        printf( "Reordered %s ( %s %s )\n", name.c_str(), left->name(),
+                right->name() );
+      std::swap( left, right );
+      std::swap( left_cost, right_cost );
+      std::swap( left_p, right_p );
+    }
+  }
+
+  binary_base_t* node =
+      static_cast<binary_base_t*>( select_binary( name, op, left, right ) );
+  node->cost = left_cost + ( samples > 0 ? 1 - left_p : 1 ) * right_cost;
+  return node;
+}
+
 // Analyzing Unary Operators ================================================
 
 template <class F>
@@ -236,7 +431,7 @@ public:
     double input_value;
     if ( input->is_constant( &input_value ) )
     {
-      double result = F()( input_value );
+      double result = F()( input->eval() );
       if ( EXPRESSION_DEBUG )
         printf( "Reduced %*d %s (%s) unary expression to %f\n", spacing, id(),
                 name(), input->name(), result );
@@ -345,102 +540,13 @@ public:
   expr_t* optimize( int spacing ) override  // override
   {
     if ( EXPRESSION_DEBUG )
-    {
       util::printf( "%*d and %lu %lu %lu %lu ( %s %s )\n", spacing, id(),
                     left_true, left_false, right_true, right_false,
                     left->name(), right->name() );
-    }
-    left                    = left->optimize( spacing + 2 );
-    right                   = right->optimize( spacing + 2 );
-    bool left_always_true   = left->always_true();
-    bool left_always_false  = left->always_false();
-    bool right_always_true  = right->always_true();
-    bool right_always_false = right->always_false();
-    if ( EXPRESSION_DEBUG )
-    {
-      if ( left->op_ == TOK_UNKNOWN )
-      {
-        if ( ( !left_always_true && left_false == 0 ) ||
-             ( !left_always_false && left_true == 0 ) )
-        {
-          printf( "consider marking expression %d %s as constant\n", left->id(),
-                  left->name() );
-        }
-      }
-      if ( right->op_ == TOK_UNKNOWN )
-      {
-        if ( ( !right_always_true && right_false == 0 ) ||
-             ( !right_always_false && right_true == 0 ) )
-        {
-          printf( "consider marking expression %d %s as constant\n",
-                  right->id(), right->name() );
-        }
-      }
-    }
-    if ( left_always_false || right_always_false )
-    {
-      if ( EXPRESSION_DEBUG )
-      {
-        printf( "Reduced %*d %s (%s, %s) and expression to false\n", spacing,
-                id(), name(), left->name(), right->name() );
-      }
-      std::string new_name = std::string( "const_and_afalse('" ) +
-          left->name() + "','" + right->name() + "')";
-      delete left;
-      delete right;
-      delete this;
-      return new const_expr_t( new_name,
-                               0.0 );
-    }
-    if ( left_always_true && right_always_true )
-    {
-      if ( EXPRESSION_DEBUG )
-      {
-        printf( "Reduced %*d %s (%s, %s) and expression to true\n", spacing,
-                id(), name(), left->name(), right->name() );
-      }
-      std::string new_name = std::string( "const_and_atrue('" ) +
-          left->name() + "','" + right->name() + "')";
-      delete left;
-      delete right;
-      delete this;
-      return new const_expr_t( new_name,
-                               1.0 );
-    }
-    if ( left_always_true )
-    {
-      if ( EXPRESSION_DEBUG )
-        printf( "Reduced %*d %s (%s) and expression to right\n", spacing, id(),
-                name(), left->name() );
-      delete left;
-      expr_t* prev_right = right;
-      delete this;
-      return prev_right;
-    }
-    if ( right_always_true )
-    {
-      if ( EXPRESSION_DEBUG )
-        printf( "Reduced %*d %s (%s) and expression to left\n", spacing, id(),
-                name(), right->name() );
-      expr_t* prev_left = left;
-      delete right;
-      delete this;
-      return prev_left;
-    }
-    // We need to separate constant propagation and flattening for proper term
-    // sorting.
-    if ( left_false < right_false )
-    {
-      std::swap( left, right->op_ == TOK_AND
-                           ? static_cast<logical_and_t*>( right )->left
-                           : right );
-    }
-    else if ( left->op_ == TOK_AND )
-    {
-      std::swap( left, right );
-      std::swap( left, static_cast<logical_and_t*>( right )->left );
-    }
-    expr_t* and_expr = new logical_and_t( name(), left, right );
+    left  = left->optimize( spacing + 2 );
+    right = right->optimize( spacing + 2 );
+    expr_t* and_expr = order_logical( name(), TOK_AND, left, right, left_false,
+                                      right_false, left_true + left_false );
     delete this;
     return and_expr;
   }
@@ -466,92 +572,13 @@ public:
   expr_t* optimize( int spacing ) override  // override
   {
     if ( EXPRESSION_DEBUG )
-    {
       util::printf( "%*d or %lu %lu %lu %lu ( %s %s )\n", spacing, id(),
                     left_true, left_false, right_true, right_false,
                     left->name(), right->name() );
-    }
-    left                    = left->optimize( spacing + 2 );
-    right                   = right->optimize( spacing + 2 );
-    bool left_always_true   = left->always_true();
-    bool left_always_false  = left->always_false();
-    bool right_always_true  = right->always_true();
-    bool right_always_false = right->always_false();
-    if ( EXPRESSION_DEBUG )
-    {
-      if ( left->op_ == TOK_UNKNOWN )
-      {
-        if ( ( !left_always_true && left_false == 0 ) ||
-             ( !left_always_false && left_true == 0 ) )
-        {
-          printf( "consider marking expression %d %s as constant\n", left->id(),
-                  left->name() );
-        }
-      }
-      if ( right->op_ == TOK_UNKNOWN )
-      {
-        if ( ( !right_always_true && right_false == 0 ) ||
-             ( !right_always_false && right_true == 0 ) )
-        {
-          printf( "consider marking expression %d %s as constant\n",
-                  right->id(), right->name() );
-        }
-      }
-    }
-    if ( left_always_true || right_always_true )
-    {
-      if ( EXPRESSION_DEBUG )
-        printf( "%*d %s or expression reduced to true\n", spacing, id(),
-                name() );
-      delete left;
-      delete right;
-      delete this;
-      return new const_expr_t( "const_or", 1.0 );
-    }
-    if ( left_always_false && right_always_false )
-    {
-      if ( EXPRESSION_DEBUG )
-        printf( "%*d %s or expression reduced to false\n", spacing, id(),
-                name() );
-      delete left;
-      delete right;
-      delete this;
-      return new const_expr_t( "const_or", 0.0 );
-    }
-    if ( left_always_false )
-    {
-      if ( EXPRESSION_DEBUG )
-        printf( "%*d %s or expression reduced to right\n", spacing, id(),
-                name() );
-      delete left;
-      expr_t* prev_right = right;
-      delete this;
-      return prev_right;
-    }
-    if ( right_always_false )
-    {
-      if ( EXPRESSION_DEBUG )
-        printf( "%*d %s or expression reduced to left\n", spacing, id(),
-                name() );
-      expr_t* prev_left = left;
-      delete right;
-      delete this;
-      return prev_left;
-    }
-    // We need to separate constant propagation and flattening for proper term
-    // sorting.
-    if ( left_true < right_true )
-    {
-      std::swap( left, right->op_ == TOK_OR
-                           ? static_cast<logical_or_t*>( right )->left
-                           : right );
-    }
-    else if ( left->op_ == TOK_OR )
-    {
-      std::swap( left, right );
-      std::swap( left, static_cast<logical_or_t*>( right )->left );
-    }
-    expr_t* or_expr = new logical_or_t( name(), left, right );
+    left  = left->optimize( spacing + 2 );
+    right = right->optimize( spacing + 2 );
+    expr_t* or_expr = order_logical( name(), TOK_OR, left, right, left_true,
+                                     right_true, left_true + left_false );
     delete this;
     return or_expr;
   }
@@ -580,75 +607,9 @@ public:
     if ( EXPRESSION_DEBUG )
       printf( "%*d xor ( %s %s )\n", spacing, id(), left->name(),
               right->name() );
-    left                    = left->optimize( spacing + 2 );
-    right                   = right->optimize( spacing + 2 );
-    bool left_always_true   = left->always_true();
-    bool left_always_false  = left->always_false();
-    bool right_always_true  = right->always_true();
-    bool right_always_false = right->always_false();
-    if ( ( left_always_true && right_always_false ) ||
-         ( left_always_false && right_always_true ) )
-    {
-      if ( EXPRESSION_DEBUG )
-        printf( "%*d %s xor expression reduced to true\n", spacing, id(),
-                name() );
-      delete left;
-      delete right;
-      delete this;
-      return new const_expr_t( "const_xor", 1.0 );
-    }
-    if ( ( left_always_true && right_always_true ) ||
-         ( left_always_false && right_always_false ) )
-    {
-      if ( EXPRESSION_DEBUG )
-        printf( "%*d %s xor expression reduced to false\n", spacing, id(),
-                name() );
-      delete left;
-      delete right;
-      delete this;
-      return new const_expr_t( "const_xor", 0.0 );
-    }
-    if ( left_always_false )
-    {
-      if ( EXPRESSION_DEBUG )
-        printf( "%*d %s xor expression reduced to right\n", spacing, id(),
-                name() );
-      delete left;
-      expr_t* prev_right = right;
-      delete this;
-      return prev_right;
-    }
-    if ( right_always_false )
-    {
-      if ( EXPRESSION_DEBUG )
-        printf( "%*d %s xor expression reduced to left\n", spacing, id(),
-                name() );
-      expr_t* prev_left = left;
-      delete right;
-      delete this;
-      return prev_left;
-    }
-    if ( left_always_true )
-    {
-      if ( EXPRESSION_DEBUG )
-        printf( "%*d %s xor expression reduced to !right\n", spacing, id(),
-                name() );
-      expr_t* not_expr = select_unary( "not_xor", TOK_NOT, right );
-      delete left;
-      delete this;
-      return not_expr;
-    }
-    if ( right_always_true )
-    {
-      if ( EXPRESSION_DEBUG )
-        printf( "%*d %s xor expression reduced to !left\n", spacing, id(),
-                name() );
-      expr_t* not_expr = select_unary( "not_xor", TOK_NOT, left );
-      delete right;
-      delete this;
-      return not_expr;
-    }
-    expr_t* xor_expr = new logical_xor_t( name(), left, right );
+    left  = left->optimize( spacing + 2 );
+    right = right->optimize( spacing + 2 );
+    expr_t* xor_expr = fold_binary( name(), TOK_XOR, left, right );
     delete this;
     return xor_expr;
   }
@@ -707,6 +668,10 @@ public:
           : expr_t( n, o ), left( l ), right( r )
         {
         }
+        ~left_reduced_t()
+        {
+          delete right;
+        }
         double evaluate() override
         {
           return F<double>()( left, right->eval() );
@@ -732,6 +697,10 @@ public:
           : expr_t( n, o ), left( l ), right( r )
         {
         }
+        ~right_reduced_t()
+        {
+          delete left;
+        }
         double evaluate() override
         {
           return F<double>()( left->eval(), right );
@@ -794,8 +763,325 @@ expr_t* select_analyze_binary( const std::string& name, token_e op,
   }
 }
 
+// Memoized Leaves ==========================================================
+
+// Expression leaves that only read actor or action target state, and so mean
+// the same thing in every action of the actor.
+bool is_memoizable( const std::string& label )
+{
+  static const char* const prefixes[] = {
+    "buff.", "debuff.", "cooldown.", "dot.", "target.", "spell_targets."
+  };
+
+  for ( const char* prefix : prefixes )
+  {
+    if ( util::str_prefix_ci( label, prefix ) )
+      return true;
+  }
+
+  return false;
+}
+
+// Share the value of a leaf between all actions of the actor within one
+// expression generation (sim_t::expr_generation) and action target.
+class memo_expr_t : public expr_t
+{
+  action_t& action;
+  expr_t* input;
+  unsigned slot;
+
+public:
+  memo_expr_t( action_t& a, expr_t* i, unsigned s )
+    : expr_t( i->name(), i->op_ ), action( a ), input( i ), slot( s )
+  {
+  }
+
+  ~memo_expr_t()
+  {
+    delete input;
+  }
+
+  double evaluate() override  // override
+  {
+    sim_t* sim             = action.sim;
+    const player_t* target = action.target;
+    uint64_t generation    = sim->expr_generation;
+    const player_t::expr_memo_t& memo = action.player->expr_memo[ slot ];
+    if ( memo.generation == generation && memo.target == target )
+    {
+      sim->event_mgr.expr_memo_hits++;
+      return memo.value;
+    }
+
+    sim->event_mgr.expr_memo_evaluations++;
+    double value = input->eval();
+
+    // Index again, expressions created lazily during evaluation may have
+    // grown the memo table
+    player_t::expr_memo_t& entry = action.player->expr_memo[ slot ];
+    entry.generation = generation;
+    entry.target     = target;
+    entry.value      = value;
+
+    return value;
+  }
+
+  bool is_constant( double* v ) override  // override
+  {
+    return input->is_constant( v );
+  }
+
+  expr_t* optimize( int spacing ) override  // override
+  {
+    input = input->optimize( spacing );
+    double v;
+    if ( input->is_constant( &v ) )
+    {
+      expr_t* constant = input;
+      input = nullptr;
+      delete this;
+      return constant;
+    }
+    return this;
+  }
+};
+
+// Expression Compiler ======================================================
+
+program_t::instruction_t make_instruction( program_t::opcode_e op )
+{
+  program_t::instruction_t i;
+  i.op    = op;
+  i.jump  = 0;
+  i.value = 0;
+  i.expr  = nullptr;
+  return i;
+}
+
+bool select_opcode( token_e op, program_t::opcode_e& opcode )
+{
+  switch ( op )
+  {
+    case TOK_MINUS: opcode = program_t::OP_NEG;   return true;
+    case TOK_NOT:   opcode = program_t::OP_NOT;   return true;
+    case TOK_ABS:   opcode = program_t::OP_ABS;   return true;
+    case TOK_FLOOR: opcode = program_t::OP_FLOOR; return true;
+    case TOK_CEIL:  opcode = program_t::OP_CEIL;  return true;
+    case TOK_ADD:   opcode = program_t::OP_ADD;   return true;
+    case TOK_SUB:   opcode = program_t::OP_SUB;   return true;
+    case TOK_MULT:  opcode = program_t::OP_MULT;  return true;
+    case TOK_DIV:   opcode = program_t::OP_DIV;   return true;
+    case TOK_EQ:    opcode = program_t::OP_EQ;    return true;
+    case TOK_NOTEQ: opcode = program_t::OP_NOTEQ; return true;
+    case TOK_LT:    opcode = program_t::OP_LT;    return true;
+    case TOK_LTEQ:  opcode = program_t::OP_LTEQ;  return true;
+    case TOK_GT:    opcode = program_t::OP_GT;    return true;
+    case TOK_GTEQ:  opcode = program_t::OP_GTEQ;  return true;
+    case TOK_XOR:   opcode = program_t::OP_XOR;   return true;
+    case TOK_AND:   opcode = program_t::OP_AND;   return true;
+    case TOK_OR:    opcode = program_t::OP_OR;    return true;
+    default:        return false;
+  }
+}
+
+// Emit code for node, with depth values already on the stack. Each node
+// leaves exactly one value on the stack.
+bool compile_node( std::vector<program_t::instruction_t>& code, expr_t* node,
+                   unsigned depth )
+{
+  if ( depth + 1 > program_t::MAX_DEPTH )
+    return false;
+
+  program_t::opcode_e opcode;
+
+  if ( const_expr_t* c = dynamic_cast<const_expr_t*>( node ) )
+  {
+    program_t::instruction_t i = make_instruction( program_t::OP_CONST );
+    c->is_constant( &i.value );
+    code.push_back( i );
+    return true;
+  }
+
+  if ( unary_base_t* u = dynamic_cast<unary_base_t*>( node ) )
+  {
+    if ( select_opcode( u->op_, opcode ) )
+    {
+      if ( !compile_node( code, u->input, depth ) )
+        return false;
+      code.push_back( make_instruction( opcode ) );
+      return true;
+    }
+  }
+
+  if ( binary_base_t* b = dynamic_cast<binary_base_t*>( node ) )
+  {
+    if ( select_opcode( b->op_, opcode ) )
+    {
+      if ( !compile_node( code, b->left, depth ) )
+        return false;
+
+      if ( opcode == program_t::OP_AND || opcode == program_t::OP_OR )
+      {
+        size_t branch = code.size();
+        code.push_back( make_instruction( opcode ) );
+        if ( !compile_node( code, b->right, depth ) )
+          return false;
+        if ( !is_truth_value( b->right ) )
+          code.push_back( make_instruction( program_t::OP_BOOL ) );
+        code[ branch ].jump = static_cast<unsigned>( code.size() );
+        return true;
+      }
+
+      // Arithmetic and comparisons against a constant take it as an
+      // immediate operand, which is the common shape of action conditions
+      const_expr_t* c = dynamic_cast<const_expr_t*>( b->right );
+      if ( c && opcode >= program_t::OP_ADD && opcode <= program_t::OP_GTEQ )
+      {
+        program_t::instruction_t i = make_instruction( static_cast<program_t::opcode_e>(
+            opcode - program_t::OP_ADD + program_t::OP_ADD_IMM ) );
+        c->is_constant( &i.value );
+        // An opaque left hand side is called by the instruction itself
+        if ( !code.empty() && code.back().op == program_t::OP_CALL &&
+             code.back().expr == b->left )
+        {
+          i.expr = b->left;
+          code.pop_back();
+        }
+        code.push_back( i );
+        return true;
+      }
+
+      if ( !compile_node( code, b->right, depth + 1 ) )
+        return false;
+      code.push_back( make_instruction( opcode ) );
+      return true;
+    }
+  }
+
+  // Anything else is opaque to the compiler
+  program_t::instruction_t i = make_instruction( program_t::OP_CALL );
+  i.expr = node;
+  code.push_back( i );
+  return true;
+}
+
 }  // UNNAMED NAMESPACE ====================================================
 
+// program_t::compile =======================================================
+
+bool program_t::compile( expr_t* root )
+{
+  clear();
+
+  // A lone opaque node gains nothing from the interpreter; expressions nested
+  // deeper than the machine stack keep using the tree as well.
+  if ( !root || !compile_node( code, root, 0 ) ||
+       ( code.size() == 1 && code[ 0 ].op == OP_CALL ) )
+  {
+    code.clear();
+    return false;
+  }
+
+  source = root;
+  return true;
+}
+
+// program_t::run ===========================================================
+
+double program_t::run() const
+{
+  // The top of the stack lives in tos, the rest below it in memory, so
+  // chains of unary and immediate operations never touch the stack array.
+  double stack[ MAX_DEPTH + 1 ];
+  double* sp = stack;
+  double tos = 0;
+
+  const instruction_t* begin = code.data();
+  const instruction_t* end   = begin + code.size();
+  const instruction_t* ip    = begin;
+
+  while ( ip != end )
+  {
+    switch ( ip->op )
+    {
+      case OP_CONST: *sp++ = tos; tos = ip->value; break;
+      case OP_CALL:  *sp++ = tos; tos = ip->expr->eval(); break;
+
+      case OP_NEG:   tos = -tos; break;
+      case OP_NOT:   tos = !tos; break;
+      case OP_ABS:   tos = std::fabs( tos ); break;
+      case OP_FLOOR: tos = std::floor( tos ); break;
+      case OP_CEIL:  tos = std::ceil( tos ); break;
+      case OP_BOOL:  tos = tos != 0; break;
+
+      case OP_ADD:   tos = *--sp + tos; break;
+      case OP_SUB:   tos = *--sp - tos; break;
+      case OP_MULT:  tos = *--sp * tos; break;
+      case OP_DIV:   tos = *--sp / tos; break;
+      case OP_EQ:    tos = *--sp == tos; break;
+      case OP_NOTEQ: tos = *--sp != tos; break;
+      case OP_LT:    tos = *--sp < tos; break;
+      case OP_LTEQ:  tos = *--sp <= tos; break;
+      case OP_GT:    tos = *--sp > tos; break;
+      case OP_GTEQ:  tos = *--sp >= tos; break;
+      case OP_XOR:   tos = ( *--sp != 0 ) != ( tos != 0 ); break;
+
+      case OP_ADD_IMM:
+      case OP_SUB_IMM:
+      case OP_MULT_IMM:
+      case OP_DIV_IMM:
+      case OP_EQ_IMM:
+      case OP_NOTEQ_IMM:
+      case OP_LT_IMM:
+      case OP_LTEQ_IMM:
+      case OP_GT_IMM:
+      case OP_GTEQ_IMM:
+        if ( ip->expr )
+        {
+          *sp++ = tos;
+          tos = ip->expr->eval();
+        }
+        switch ( ip->op )
+        {
+          case OP_ADD_IMM:   tos = tos + ip->value; break;
+          case OP_SUB_IMM:   tos = tos - ip->value; break;
+          case OP_MULT_IMM:  tos = tos * ip->value; break;
+          case OP_DIV_IMM:   tos = tos / ip->value; break;
+          case OP_EQ_IMM:    tos = tos == ip->value; break;
+          case OP_NOTEQ_IMM: tos = tos != ip->value; break;
+          case OP_LT_IMM:    tos = tos < ip->value; break;
+          case OP_LTEQ_IMM:  tos = tos <= ip->value; break;
+          case OP_GT_IMM:    tos = tos > ip->value; break;
+          default:           tos = tos >= ip->value; break;
+        }
+        break;
+
+      case OP_AND:
+        if ( tos == 0 )
+        {
+          tos = 0;
+          ip = begin + ip->jump;
+          continue;
+        }
+        tos = *--sp;
+        break;
+      case OP_OR:
+        if ( tos != 0 )
+        {
+          tos = 1;
+          ip = begin + ip->jump;
+          continue;
+        }
+        tos = *--sp;
+        break;
+    }
+    ++ip;
+  }
+
+  assert( sp == stack + 1 );
+  return tos;
+}
+
 // precedence ===============================================================
 
 int precedence( token_e expr_token_type )
@@ -1209,6 +1495,16 @@ static expr_t* build_expression_tree(
             action->player->name(), action->name(), t.label.c_str() );
         return nullptr;
       }
+      double v;
+      if ( action->sim->memoize_expressions &&
+           expression::is_memoizable( t.label ) && !e->is_constant( &v ) )
+      {
+        // Slots are keyed by the expression type too, in case an action
+        // overrides the generic meaning of the expression
+        unsigned slot = action->player->expr_memo_slot(
+            t.label + '#' + typeid( *e ).name() );
+        e = new expression::memo_expr_t( *action, e, slot );
+      }
       stack.push_back( e );
     }
     else if ( expression::is_unary( t.type ) )
@@ -1295,6 +1591,8 @@ expr_t* expr_t::parse( action_t* action, const std::string& expr_str,
 
 #ifdef UNIT_TEST
 
+#include <random>
+
 uint32_t dbc::get_school_mask( school_e )
 {
   return 0;
@@ -1302,16 +1600,26 @@ uint32_t dbc::get_school_mask( school_e )
 
 namespace
 {
+using namespace expression;
+
+// print_tokens() writes to the sim debug output, there is no sim here
+void dump_tokens( const std::vector<expr_token_t>& tokens )
+{
+  for ( size_t i = 0; i < tokens.size(); i++ )
+    printf( "%s%2d '%s'", i > 0 ? " | " : "tokens: ", tokens[ i ].type, tokens[ i ].label.c_str() );
+  puts( "" );
+}
+
 expr_t* parse_expression( const char* arg )
 {
-  std::vector<expr_token_t> tokens = expression_t::parse_tokens( 0, arg );
-  expression_t::convert_to_unary( tokens );
-  expression_t::print_tokens( tokens, 0 );
+  std::vector<expr_token_t> tokens = parse_tokens( 0, arg );
+  convert_to_unary( tokens );
+  dump_tokens( tokens );
 
-  if ( expression_t::convert_to_rpn( tokens ) )
+  if ( convert_to_rpn( tokens ) )
   {
     puts( "rpn:" );
-    expression_t::print_tokens( tokens, 0 );
+    dump_tokens( tokens );
 
     return build_expression_tree( 0, tokens, false );
   }
@@ -1322,32 +1630,164 @@ expr_t* parse_expression( const char* arg )
 void time_test( expr_t* expr, uint64_t n )
 {
   double value        = 0;
-  const int64_t start = util::milliseconds();
+  const double start = util::wall_time();
+  for ( uint64_t i = 0; i < n; ++i )
+    value           = expr->eval();
+  const double stop = util::wall_time();
+  printf( "evaluate: %f in %.4f seconds\n", value, stop - start );
+
+  expression::program_t program;
+  if ( !program.compile( expr ) )
+  {
+    puts( "compile: expression too deep" );
+    return;
+  }
+  const double compiled_start = util::wall_time();
   for ( uint64_t i = 0; i < n; ++i )
-    value            = expr->eval();
-  const int64_t stop = util::milliseconds();
-  printf( "evaluate: %f in %.4f seconds\n", value, ( stop - start ) / 1000.0 );
+    value = program.run();
+  const double compiled_stop = util::wall_time();
+  printf( "compiled: %f in %.4f seconds (%u instructions)\n", value,
+          compiled_stop - compiled_start, static_cast<unsigned>( program.code.size() ) );
 }
+
+// Differential check of expression optimization ============================
+
+const size_t N_TEST_VARIABLES = 8;
+double test_variables[ N_TEST_VARIABLES ];
+
+struct test_variable_expr_t : public expr_t
+{
+  size_t index;
+
+  test_variable_expr_t( size_t i ) : expr_t( "var" ), index( i )
+  {
+  }
+
+  double evaluate() override
+  {
+    return test_variables[ index ];
+  }
+};
+
+const double test_values[] = { 0, 1, -1, 2.5, -0.0, 3, std::numeric_limits<double>::quiet_NaN() };
+const size_t N_TEST_VALUES = sizeof( test_values ) / sizeof( test_values[ 0 ] );
+
+// Random operator tree over test variables and constants. The same generator
+// state gives the same tree with plain or analyzing operators.
+expr_t* random_tree( std::mt19937& rng, int depth, bool analyze )
+{
+  if ( depth == 0 || rng() % 4 == 0 )
+  {
+    if ( rng() % 3 )
+      return new test_variable_expr_t( rng() % N_TEST_VARIABLES );
+    return new const_expr_t( "const", test_values[ rng() % N_TEST_VALUES ] );
+  }
+
+  if ( rng() % 5 == 0 )
+  {
+    static const token_e unary_ops[] = { TOK_MINUS, TOK_NOT, TOK_ABS, TOK_FLOOR, TOK_CEIL };
+    expr_t* input = random_tree( rng, depth - 1, analyze );
+    token_e op    = unary_ops[ rng() % 5 ];
+    return analyze ? select_analyze_unary( "unary", op, input )
+                   : select_unary( "unary", op, input );
+  }
+
+  // Logical operators are drawn more often, they are what optimization reorders
+  static const token_e binary_ops[] = { TOK_ADD, TOK_SUB,   TOK_MULT, TOK_DIV,  TOK_EQ,
+                                        TOK_NOTEQ, TOK_LT,  TOK_LTEQ, TOK_GT,   TOK_GTEQ,
+                                        TOK_AND, TOK_OR,    TOK_XOR,  TOK_AND,  TOK_OR };
+  expr_t* left  = random_tree( rng, depth - 1, analyze );
+  expr_t* right = random_tree( rng, depth - 1, analyze );
+  token_e op    = binary_ops[ rng() % 15 ];
+  return analyze ? select_analyze_binary( "binary", op, left, right )
+                 : select_binary( "binary", op, left, right );
 }
 
-void sim_t::cancel()
+/* Evaluate n random trees after optimize() against the same, unoptimized
+ * trees, on a set of variable assignments including NaN and -0. Analyzing
+ * trees gather their statistics on the assignments before they are
+ * optimized. Returns the number of mismatching results.
+ */
+unsigned differential_test( unsigned n )
 {
+  const unsigned n_assignments = 30;
+  std::mt19937 rng( 7 );
+  unsigned mismatches = 0, checks = 0;
+
+  for ( int analyze = 0; analyze < 2; ++analyze )
+  {
+    for ( unsigned i = 0; i < n; ++i )
+    {
+      unsigned seed = rng();
+      std::mt19937 tree_rng( seed );
+      expr_t* reference = random_tree( tree_rng, 6, false );
+      tree_rng.seed( seed );
+      expr_t* expr = random_tree( tree_rng, 6, analyze != 0 );
+
+      std::vector<double> assignments( n_assignments * N_TEST_VARIABLES );
+      for ( auto& v : assignments )
+        v = test_values[ tree_rng() % N_TEST_VALUES ];
+
+      if ( analyze )
+      {
+        for ( unsigned j = 0; j < n_assignments; ++j )
+        {
+          std::copy_n( &assignments[ j * N_TEST_VARIABLES ], N_TEST_VARIABLES, test_variables );
+          expr->eval();
+        }
+      }
+
+      expr = expr->optimize();
+
+      // The compiled program of the optimized tree has to agree as well
+      expression::program_t program;
+      bool compiled = program.compile( expr );
+
+      for ( unsigned j = 0; j < n_assignments; ++j )
+      {
+        std::copy_n( &assignments[ j * N_TEST_VARIABLES ], N_TEST_VARIABLES, test_variables );
+        double expected = reference->eval();
+        double value    = expr->eval();
+        ++checks;
+        if ( value != expected && !( std::isnan( value ) && std::isnan( expected ) ) )
+        {
+          if ( mismatches++ < 5 )
+            printf( "differential: tree %u (analyze=%d) optimized %f, expected %f\n", i, analyze, value,
+                    expected );
+        }
+
+        if ( !compiled )
+          continue;
+
+        value = program.run();
+        ++checks;
+        if ( value != expected && !( std::isnan( value ) && std::isnan( expected ) ) )
+        {
+          if ( mismatches++ < 5 )
+            printf( "differential: tree %u (analyze=%d) compiled %f, expected %f\n", i, analyze, value,
+                    expected );
+        }
+      }
+
+      delete reference;
+      delete expr;
+    }
+  }
+
+  printf( "differential: %u mismatches in %u evaluations\n", mismatches, checks );
+  return mismatches;
+}
 }
 
-int sim_t::errorf( const char* format, ... )
+void sim_t::cancel()
 {
-  va_list ap;
-  va_start( ap, format );
-  int result = vfprintf( stderr, format, ap );
-  va_end( ap );
-  return result;
 }
 
-void sim_t::output( sim_t*, const char* format, ... )
+void sim_t::errorf( const char* format, ... )
 {
   va_list ap;
   va_start( ap, format );
-  vfprintf( stdout, format, ap );
+  vfprintf( stderr, format, ap );
   va_end( ap );
 }
 
@@ -1367,6 +1807,18 @@ int main( int argc, char** argv )
       continue;
     }
 
+    if ( util::str_compare_ci( argv[ i ], "-d" ) )
+    {
+      ++i;
+      assert( i < argc );
+      unsigned n_trees = 0;
+      std::istringstream is( argv[ i ] );
+      is >> n_trees;
+      if ( differential_test( n_trees ) > 0 )
+        return 1;
+      continue;
+    }
+
     expr_t* expr = parse_expression( argv[ i ] );
     if ( expr )
     {
@@ -1374,6 +1826,9 @@ int main( int argc, char** argv )
       {
         puts( "evaluate:" );
         printf( "%f\n", expr->eval() );
+        expression::program_t program;
+        if ( program.compile( expr ) )
+          printf( "compiled: %f\n", program.run() );
       }
       else
         time_test( expr, n_evals );
@@ -270,3 +270,82 @@ inline expr_t* expr_t::create_constant( const std::string& name, T value )
   return new const_expr_t( name, coerce(value) );
 }
 
+
+namespace expression
+{
+// Compiled expression ======================================================
+
+/// Linear lowering of an (optimized) expression tree.
+///
+/// Operator nodes are flattened into a short instruction stream for a small
+/// stack machine, constants are inlined, and every other node (leaves,
+/// analyzing or reduced operators) becomes a single call to its evaluate().
+/// Logical and/or keep their short-circuit semantics through forward jumps.
+/// The program borrows the nodes of the source tree, so it has to be
+/// recompiled whenever the tree is optimized or replaced.
+struct program_t
+{
+  static const unsigned MAX_DEPTH = 32;
+
+  enum opcode_e
+  {
+    OP_CONST = 0,
+    OP_CALL,
+    OP_NEG,
+    OP_NOT,
+    OP_ABS,
+    OP_FLOOR,
+    OP_CEIL,
+    OP_ADD,
+    OP_SUB,
+    OP_MULT,
+    OP_DIV,
+    OP_EQ,
+    OP_NOTEQ,
+    OP_LT,
+    OP_LTEQ,
+    OP_GT,
+    OP_GTEQ,
+    OP_XOR,
+    // Binary operators with a constant right hand side in value
+    OP_ADD_IMM,
+    OP_SUB_IMM,
+    OP_MULT_IMM,
+    OP_DIV_IMM,
+    OP_EQ_IMM,
+    OP_NOTEQ_IMM,
+    OP_LT_IMM,
+    OP_LTEQ_IMM,
+    OP_GT_IMM,
+    OP_GTEQ_IMM,
+    OP_AND,   // Top false: leave 0, jump. Otherwise pop.
+    OP_OR,    // Top true: leave 1, jump. Otherwise pop.
+    OP_BOOL
+  };
+
+  struct instruction_t
+  {
+    opcode_e op;
+    unsigned jump;
+    double value;
+    expr_t* expr;
+  };
+
+  std::vector<instruction_t> code;
+  expr_t* source;
+
+  // Differential mode bookkeeping
+  unsigned mismatches;
+
+  program_t() : source( nullptr ), mismatches( 0 )
+  { }
+
+  bool compile( expr_t* root );
+  void clear()
+  { code.clear(); source = nullptr; mismatches = 0; }
+  bool compiled( const expr_t* root ) const
+  { return source != nullptr && source == root; }
+
+  double run() const;
+};
+}
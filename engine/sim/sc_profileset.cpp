@@ -67,6 +67,29 @@ bool in_player_scope( const option_tuple_t& opt )
   } ) != player_scope_opts.end();
 }
 
+// Number of profilesets simulated concurrently. profileset_work_threads > 1 simulates that many
+// profilesets at the same time, sharing the threads of the parent simulator.
+int n_workers( const sim_t* sim )
+{
+  return std::max( 1, std::min( sim -> profileset_work_threads, sim -> threads ) );
+}
+
+// Metrics where the smallest value is the best one
+bool lower_is_better( scale_metric_e metric )
+{
+  switch ( metric )
+  {
+    case SCALE_METRIC_DTPS:
+    case SCALE_METRIC_DMG_TAKEN:
+    case SCALE_METRIC_TMI:
+    case SCALE_METRIC_ETMI:
+    case SCALE_METRIC_DEATHS:
+      return true;
+    default:
+      return false;
+  }
+}
+
 sim_control_t* profilesets_t::create_sim_options( const sim_control_t*            original,
                                                   const std::vector<std::string>& opts )
 {
@@ -137,7 +160,7 @@ sim_control_t* profilesets_t::create_sim_options( const sim_control_t*
 }
 
 profile_set_t::profile_set_t( const std::string& name, sim_control_t* opts, bool has_output ) :
-  m_name( name ), m_options( opts ), m_has_output( has_output )
+  m_name( name ), m_options( opts ), m_has_output( has_output ), m_samples(), m_done( false )
 {
 }
 
@@ -146,6 +169,23 @@ sim_control_t* profile_set_t::options() const
   return m_options;
 }
 
+// Accumulate the metric samples of a racing round, and analyze all samples so far
+const extended_sample_data_t& profile_set_t::add_samples( const extended_sample_data_t& samples )
+{
+  if ( ! m_samples )
+  {
+    m_samples = std::unique_ptr<extended_sample_data_t>( new extended_sample_data_t( samples ) );
+  }
+  else
+  {
+    m_samples -> merge( samples );
+  }
+
+  m_samples -> analyze();
+
+  return *m_samples;
+}
+
 profile_set_t::~profile_set_t()
 {
   delete m_options;
@@ -250,7 +290,7 @@ bool profilesets_t::parse( sim_t* sim )
     m_profilesets.push_back( std::unique_ptr<profile_set_t>(
         new profile_set_t( it -> first, control, has_output_opts ) ) );
     m_mutex.unlock();
-    m_control.notify_one();
+    m_control.notify_all();
   }
 
   set_state( RUNNING );
@@ -292,93 +332,323 @@ void profilesets_t::set_state( state new_state )
   m_state = new_state;
 
   m_mutex.unlock();
+
+  // Wake up any profileset workers waiting for work
+  m_control.notify_all();
 }
 
-bool profilesets_t::iterate( sim_t* parent )
+// Fetch the next profileset to simulate, waiting for the parser thread if necessary. Returns
+// nullptr once all profilesets have been handed out, or if profileset simulation has stopped.
+// The number of threads the profileset simulation may use is returned in threads.
+profile_set_t* profilesets_t::fetch( const sim_t* parent, int& threads )
 {
-  if ( parent -> profileset_map.size() == 0 )
+  std::unique_lock<std::mutex> lock( m_mutex );
+
+  // Wait until we have at least something to sim
+  while ( ( m_state == STARTED || m_state == INITIALIZING ) && m_profilesets.size() == m_work_index )
   {
-    return true;
+    m_control.wait( lock );
+  }
+
+  // Profilesets that finished or were eliminated in earlier racing rounds are skipped
+  while ( m_work_index < m_profilesets.size() && m_profilesets[ m_work_index ] -> done() )
+  {
+    ++m_work_index;
   }
 
-  auto original_opts = parent -> control;
+  if ( m_state == DONE || m_failed || m_work_index == m_profilesets.size() )
+  {
+    return nullptr;
+  }
+
+  // The free threads are spread over the idle workers that still have profilesets left to
+  // simulate, giving the last profilesets more threads. Deterministic results do not depend on the
+  // number of threads.
+  auto remaining = parent -> profileset_map.size() - m_work_index;
+  auto share = std::min( static_cast<size_t>( m_idle_workers ), remaining );
+  threads = std::max( 1, m_free_threads / static_cast<int>( std::max( share, size_t( 1 ) ) ) );
+
+  m_free_threads -= threads;
+  --m_idle_workers;
+
+  return m_profilesets[ m_work_index++ ].get();
+}
+
+void profilesets_t::release( int threads )
+{
+  std::lock_guard<std::mutex> lock( m_mutex );
 
-  while ( ! is_done() )
+  m_free_threads += threads;
+  ++m_idle_workers;
+}
+
+bool profilesets_t::simulate( sim_t* parent, profile_set_t* set, int threads, bool report_progress )
+{
+  sim_t* profile_sim = nullptr;
+
+  // Child simulators are set up from the parent's control object, so profileset simulator
+  // construction is serialized
   {
-    m_control_lock.lock();
+    std::lock_guard<std::mutex> lock( m_sim_mutex );
+
+    auto original_opts = parent -> control;
+    parent -> control = set -> options();
 
-    // Wait until we have at least something to sim
-    while ( is_initializing() && m_profilesets.size() - m_work_index == 0 )
+    profile_sim = new sim_t( parent );
+
+    parent -> control = original_opts;
+  }
+
+  // A racing round simulates a fixed number of iterations, the results of the rounds are
+  // accumulated until the iterations or the target error of the profileset are reached
+  bool racing = parent -> profileset_race_iterations > 0;
+  int max_iterations = profile_sim -> iterations;
+  double target_error = profile_sim -> target_error;
+  // Each round continues the iteration numbering of the earlier rounds of the profileset. Numbered
+  // (deterministic) sims derive the random streams of an iteration from its number, so a round
+  // starting again from iteration 0 would replay, and duplicate, the samples of the first round.
+  auto first_iteration = static_cast<unsigned>( set -> result().iterations() );
+  if ( racing )
+  {
+    int remaining = max_iterations - static_cast<int>( first_iteration );
+    profile_sim -> target_error = 0;
+    profile_sim -> work_queue -> init( std::max( 1, std::min( parent -> profileset_race_iterations, remaining ) ) );
+    profile_sim -> work_queue -> first_iteration( first_iteration );
+    profile_sim -> total_numbered_iterations = static_cast<unsigned>( max_iterations );
+  }
+
+  // Reset random seed for the profileset sims
+  profile_sim -> seed = 0;
+  profile_sim -> profileset_enabled = true;
+  profile_sim -> report_details = 0;
+  profile_sim -> threads = threads;
+  if ( ! report_progress )
+  {
+    profile_sim -> report_progress = 0;
+  }
+  profile_sim -> progress_bar.set_base( "Profileset" );
+  profile_sim -> progress_bar.set_phase( set -> name() );
+
+  auto ret = profile_sim -> execute();
+  if ( ret )
+  {
+    profile_sim -> progress_bar.restart();
+
+    if ( set -> has_output() )
     {
-      m_control.wait( m_control_lock );
+      std::lock_guard<std::mutex> lock( m_sim_mutex );
+      report::print_suite( profile_sim );
     }
+  }
+
+  if ( ret == false || profile_sim -> is_canceled() )
+  {
+    delete profile_sim;
+    return false;
+  }
+
+  const auto player = profile_sim -> player_no_pet_list.data().front();
+  auto progress = profile_sim -> progress( nullptr, 0 );
+  size_t iterations = progress.current_iterations;
+  statistical_data_t data;
 
-    // Break out of iteration loop if all work has been done
-    if ( is_running() )
+  if ( racing )
+  {
+    extended_sample_data_t haps( player -> name_str + " Healing + Absorb per second" );
+    auto round_samples = metric_samples( player, haps );
+    if ( ! round_samples )
     {
-      if ( m_work_index == m_profilesets.size() )
-      {
-        m_control_lock.unlock();
-        break;
-      }
+      std::lock_guard<std::mutex> lock( m_sim_mutex );
+      parent -> errorf( "Profileset racing requires per-iteration samples of metric '%s', "
+                        "which are not stored with the current statistics settings",
+                        util::scale_metric_type_abbrev( parent -> profileset_metric ) );
+      delete profile_sim;
+      return false;
     }
 
-    const auto& set = m_profilesets[ m_work_index++ ];
+    auto replayed = range::find_if( profile_sim -> sample_iterations,
+        [ first_iteration ]( unsigned n ) { return n < first_iteration; } );
+    if ( replayed != profile_sim -> sample_iterations.end() )
+    {
+      std::lock_guard<std::mutex> lock( m_sim_mutex );
+      parent -> errorf( "Profileset '%s' racing round replayed iteration %u of an earlier round",
+                        set -> name().c_str(), *replayed );
+      delete profile_sim;
+      return false;
+    }
 
-    m_control_lock.unlock();
+    const auto& samples = set -> add_samples( *round_samples );
+    data = collect( samples );
+    iterations += set -> result().iterations();
 
-    parent -> control = set -> options();
+    bool done = iterations >= static_cast<size_t>( max_iterations );
+    if ( target_error > 0 && samples.mean() != 0 )
+    {
+      done = done || 100 * sim_t::distribution_mean_error( *profile_sim, samples ) /
+                     std::fabs( samples.mean() ) < target_error;
+    }
+    set -> done( done );
+  }
+  else
+  {
+    data = metric_data( player );
+  }
+
+  set -> result()
+    .min( data.min )
+    .first_quartile( data.first_quartile )
+    .median( data.median )
+    .mean( data.mean )
+    .third_quartile( data.third_quartile )
+    .max( data.max )
+    .stddev( data.std_dev )
+    .iterations( iterations );
+
+  delete profile_sim;
+
+  return true;
+}
+
+void profilesets_t::worker( sim_t* parent, bool report_progress )
+{
+  int threads = 0;
+
+  while ( auto set = fetch( parent, threads ) )
+  {
+    auto ret = simulate( parent, set, threads, report_progress );
+
+    release( threads );
+
+    if ( ! ret )
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_failed = true;
+      return;
+    }
+  }
+}
+
+// Simulate all profilesets that are not done yet
+bool profilesets_t::run( sim_t* parent )
+{
+  m_mutex.lock();
+  m_idle_workers = n_workers( parent );
+  m_free_threads = std::max( 1, parent -> threads );
+  m_work_index = 0;
+  m_failed = false;
+  m_mutex.unlock();
+
+  // The calling thread acts as the first worker, and is the only one reporting progress
+  std::vector<std::unique_ptr<sc_task_thread_t>> workers;
+  for ( int i = 1; i < n_workers( parent ); ++i )
+  {
+    workers.emplace_back( new sc_task_thread_t( [ this, parent ]() { worker( parent, false ); } ) );
+    workers.back() -> launch();
+  }
+
+  worker( parent, true );
 
-    auto profile_sim = new sim_t( parent );
+  for ( auto& t : workers )
+  {
+    t -> join();
+  }
 
-    // Reset random seed for the profileset sims
-    profile_sim -> seed = 0;
-    profile_sim -> profileset_enabled = true;
-    profile_sim -> report_details = 0;
-    profile_sim -> progress_bar.set_base( "Profileset" );
-    profile_sim -> progress_bar.set_phase( set -> name() );
+  return ! m_failed;
+}
 
-    auto ret = profile_sim -> execute();
-    if ( ret )
+// Eliminate the profilesets whose confidence interval is below the confidence interval of the
+// best profileset by more than profileset_race_margin percent of the best mean. Returns the
+// number of profilesets still racing.
+size_t profilesets_t::eliminate( const sim_t* parent )
+{
+  double sign = lower_is_better( parent -> profileset_metric ) ? -1.0 : 1.0;
+
+  // Lower bound of the best profileset, in the direction where larger values are better
+  const profile_set_t* best = nullptr;
+  double best_lower = 0;
+  for ( const auto& set : m_profilesets )
+  {
+    if ( set -> result().eliminated() || set -> result().iterations() == 0 )
     {
-      profile_sim -> progress_bar.restart();
+      continue;
+    }
 
-      if ( set -> has_output() )
-      {
-        report::print_suite( profile_sim );
-      }
+    const auto& r = set -> result();
+    double lower = sign * r.mean() - parent -> confidence_estimator * r.stddev() / std::sqrt( r.iterations() );
+    if ( ! best || lower > best_lower )
+    {
+      best = set.get();
+      best_lower = lower;
     }
+  }
+
+  if ( ! best )
+  {
+    return 0;
+  }
+
+  double threshold = best_lower - std::fabs( best -> result().mean() ) * parent -> profileset_race_margin / 100.0;
 
-    if ( ret == false || profile_sim -> is_canceled() )
+  size_t racing = 0;
+  for ( auto& set : m_profilesets )
+  {
+    if ( set -> done() )
     {
-      parent -> control = original_opts;
-      set_state( DONE );
-      delete profile_sim;
-      return false;
+      continue;
     }
 
-    const auto player = profile_sim -> player_no_pet_list.data().front();
-    auto progress = profile_sim -> progress( nullptr, 0 );
-    auto data = metric_data( player );
+    auto& r = set -> result();
+    double upper = sign * r.mean() + parent -> confidence_estimator * r.stddev() / std::sqrt( r.iterations() );
+    if ( upper < threshold )
+    {
+      r.eliminated( true );
+      set -> done( true );
+    }
+    else
+    {
+      ++racing;
+    }
+  }
 
-    set -> result()
-      .min( data.min )
-      .first_quartile( data.first_quartile )
-      .median( data.median )
-      .mean( data.mean )
-      .third_quartile( data.third_quartile )
-      .max( data.max )
-      .stddev( data.std_dev )
-      .iterations( progress.current_iterations );
+  return racing;
+}
 
-    delete profile_sim;
+// Simulate the profilesets in rounds of profileset_race_iterations, eliminating the clearly worse
+// profilesets after each round
+bool profilesets_t::race( sim_t* parent )
+{
+  // All profilesets race against each other, so wait for the parser to finish
+  {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    while ( m_state == STARTED || m_state == INITIALIZING )
+    {
+      m_control.wait( lock );
+    }
   }
 
-  parent -> control = original_opts;
+  do
+  {
+    if ( ! run( parent ) )
+    {
+      return false;
+    }
+  } while ( ! is_done() && eliminate( parent ) > 0 );
+
+  return true;
+}
+
+bool profilesets_t::iterate( sim_t* parent )
+{
+  if ( parent -> profileset_map.size() == 0 )
+  {
+    return true;
+  }
+
+  auto ret = parent -> profileset_race_iterations > 0 ? race( parent ) : run( parent );
 
   set_state( DONE );
 
-  return true;
+  return ret;
 }
 
 int profilesets_t::max_name_length() const
@@ -424,6 +694,11 @@ void profilesets_t::output( const sim_t& sim, js::JsonOutput& root ) const
     }
 
     obj[ "iterations" ] = as<uint64_t>( result.iterations() );
+
+    if ( result.eliminated() )
+    {
+      obj[ "eliminated" ] = true;
+    }
   } );
 }
 
@@ -441,8 +716,17 @@ void profilesets_t::output( const sim_t& sim, FILE* out ) const
   generate_sorted_profilesets( results );
 
   range::for_each( results, [ out ]( const profile_set_t* profileset ) {
-    util::fprintf( out, "    %-10.3f : %s\n",
-      profileset -> result().median(), profileset -> name().c_str() );
+    if ( profileset -> result().eliminated() )
+    {
+      util::fprintf( out, "    %-10.3f : %s (eliminated at %u iterations)\n",
+        profileset -> result().median(), profileset -> name().c_str(),
+        as<unsigned>( profileset -> result().iterations() ) );
+    }
+    else
+    {
+      util::fprintf( out, "    %-10.3f : %s\n",
+        profileset -> result().median(), profileset -> name().c_str() );
+    }
   } );
 }
 
@@ -565,7 +849,13 @@ bool profilesets_t::generate_chart( const sim_t& sim, io::ofstream& out ) const
         inserted = true;
       }
 
-      insert_data( profileset, set -> name(), c, set -> result().statistical_data(), false );
+      std::string name = set -> name();
+      if ( set -> result().eliminated() )
+      {
+        name += " (eliminated at " + util::to_string( set -> result().iterations() ) + " iterations)";
+      }
+
+      insert_data( profileset, name, c, set -> result().statistical_data(), false );
     }
 
     if ( inserted == false )
@@ -584,6 +874,9 @@ bool profilesets_t::generate_chart( const sim_t& sim, io::ofstream& out ) const
 void create_options( sim_t* sim )
 {
   sim -> add_option( opt_map_list( "profileset.", sim -> profileset_map ) );
+  sim -> add_option( opt_int( "profileset_work_threads", sim -> profileset_work_threads ) );
+  sim -> add_option( opt_int( "profileset_race_iterations", sim -> profileset_race_iterations ) );
+  sim -> add_option( opt_float( "profileset_race_margin", sim -> profileset_race_margin ) );
   sim -> add_option( opt_func( "profileset_metric", []( sim_t*             sim,
                                                         const std::string&,
                                                         const std::string& value ) {
@@ -640,4 +933,42 @@ statistical_data_t metric_data( const player_t* player )
   }
 }
 
+const extended_sample_data_t* metric_samples( const player_t* player, extended_sample_data_t& haps )
+{
+  const auto& d = player -> collected_data;
+
+  switch ( player -> sim -> profileset_metric )
+  {
+    case SCALE_METRIC_DPS:       return &d.dps;
+    case SCALE_METRIC_DPSE:      return &d.dpse;
+    case SCALE_METRIC_HPS:       return &d.hps;
+    case SCALE_METRIC_HPSE:      return &d.hpse;
+    case SCALE_METRIC_APS:       return &d.aps;
+    case SCALE_METRIC_DPSP:      return &d.prioritydps;
+    case SCALE_METRIC_DTPS:      return &d.dtps;
+    case SCALE_METRIC_DMG_TAKEN: return &d.dmg_taken;
+    case SCALE_METRIC_HTPS:      return &d.htps;
+    case SCALE_METRIC_TMI:       return &d.theck_meloree_index;
+    case SCALE_METRIC_ETMI:      return &d.effective_theck_meloree_index;
+    case SCALE_METRIC_DEATHS:    return &d.deaths;
+    case SCALE_METRIC_HAPS:
+    {
+      // Healing and absorbs are collected on the same iterations, but their sum can only be
+      // formed from the individual samples
+      if ( d.hps.simple || d.hps.sketch || d.aps.simple || d.aps.sketch )
+      {
+        return nullptr;
+      }
+
+      haps.change_mode( false );
+      for ( size_t i = 0; i < d.hps.stored_samples() && i < d.aps.stored_samples(); ++i )
+      {
+        haps.add( d.hps.sample( i ) + d.aps.sample( i ) );
+      }
+      return &haps;
+    }
+    default:                     return nullptr;
+  }
+}
+
 } /* Namespace profileset ends */
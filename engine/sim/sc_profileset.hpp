@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -41,10 +42,11 @@ class profile_result_t
   double         m_3rdquartile;
   double         m_stddev;
   size_t         m_iterations;
+  bool           m_eliminated;
 
 public:
   profile_result_t() : m_mean( 0 ), m_median( 0 ), m_min( 0 ), m_max( 0 ), m_1stquartile( 0 ),
-    m_3rdquartile( 0 ), m_stddev( 0 ), m_iterations( 0 )
+    m_3rdquartile( 0 ), m_stddev( 0 ), m_iterations( 0 ), m_eliminated( false )
   { }
 
   double mean() const
@@ -95,6 +97,13 @@ public:
   profile_result_t& iterations( size_t i )
   { m_iterations = i; return *this; }
 
+  // Stopped early by racing, the result holds the interim stats
+  bool eliminated() const
+  { return m_eliminated; }
+
+  profile_result_t& eliminated( bool v )
+  { m_eliminated = v; return *this; }
+
   statistical_data_t statistical_data() const
   { return { m_min, m_1stquartile, m_median, m_mean, m_3rdquartile, m_max, m_stddev }; }
 };
@@ -105,6 +114,9 @@ class profile_set_t
   sim_control_t*   m_options;
   profile_result_t m_result;
   bool             m_has_output;
+  // Racing state, metric samples of all simulated rounds
+  std::unique_ptr<extended_sample_data_t> m_samples;
+  bool             m_done;
 
 public:
   profile_set_t( const std::string& name, sim_control_t* opts, bool has_ouput );
@@ -124,6 +136,14 @@ public:
 
   bool has_output() const
   { return m_has_output; }
+
+  const extended_sample_data_t& add_samples( const extended_sample_data_t& samples );
+
+  bool done() const
+  { return m_done; }
+
+  void done( bool v )
+  { m_done = v; }
 };
 
 
@@ -148,9 +168,13 @@ class profilesets_t
   int64_t                        m_insert_index;
   size_t                         m_work_index;
   std::mutex                     m_mutex;
-  std::unique_lock<std::mutex>   m_control_lock;
+  std::mutex                     m_sim_mutex;
   std::condition_variable        m_control;
   std::thread                    m_thread;
+  // Concurrent profileset simulation bookkeeping, protected by m_mutex
+  int                            m_idle_workers;
+  int                            m_free_threads;
+  bool                           m_failed;
 
   bool validate( sim_t* sim );
 
@@ -162,9 +186,17 @@ class profilesets_t
   void set_state( state new_state );
 
   sim_control_t* create_sim_options( const sim_control_t*, const std::vector<std::string>& opts );
+
+  profile_set_t* fetch( const sim_t* parent, int& threads );
+  void release( int threads );
+  bool simulate( sim_t* parent, profile_set_t* set, int threads, bool report_progress );
+  void worker( sim_t* parent, bool report_progress );
+  bool run( sim_t* parent );
+  bool race( sim_t* parent );
+  size_t eliminate( const sim_t* parent );
 public:
   profilesets_t() : m_state( STARTED ), m_original( nullptr ), m_insert_index( -1 ),
-    m_work_index( 0 ), m_control_lock( m_mutex, std::defer_lock )
+    m_work_index( 0 ), m_idle_workers( 0 ), m_free_threads( 0 ), m_failed( false )
   { }
 
   ~profilesets_t()
@@ -201,6 +233,9 @@ void create_options( sim_t* sim );
 
 statistical_data_t collect( const extended_sample_data_t& c );
 statistical_data_t metric_data( const player_t* player );
+// Per-iteration samples of the profileset metric. Single metrics are returned directly, HAPS is
+// combined into the haps buffer. Returns nullptr if the samples are not available.
+const extended_sample_data_t* metric_samples( const player_t* player, extended_sample_data_t& haps );
 
 } /* Namespace profileset ends */
 
@@ -68,7 +68,7 @@ void progress_bar_t::init()
   else
   {
     interval = sim.work_queue -> size();
-    if ( sim.deterministic || sim.strict_work_queue )
+    if ( sim.strict_work_queue )
     {
       interval *= sim.threads;
     }
@@ -567,6 +567,7 @@ void progress_bar_t::add_simulation_time( double t )
   }
   else
   {
+    AUTO_LOCK( time_mutex );
     elapsed_time += t;
     time_count++;
   }
@@ -579,5 +580,6 @@ double progress_bar_t::average_simulation_time() const
     return sim.parent -> progress_bar.average_simulation_time();
   }
 
+  AUTO_LOCK( time_mutex );
   return time_count > 0 ? elapsed_time / time_count : 0;
 }
@@ -70,6 +70,69 @@ bool parse_normalize_scale_factors( sim_t* sim,
   return true;
 }
 
+// paired_mean_std_dev ======================================================
+
+// Standard deviation of the mean of the per-iteration differences between delta and reference
+// samples, paired by their global iteration number (correlated_sampling). Returns a negative
+// value if the samples cannot be paired.
+double paired_mean_std_dev( const sim_t& delta_sim, const extended_sample_data_t& delta,
+                            const sim_t& ref_sim, const extended_sample_data_t& ref )
+{
+  const std::vector<unsigned>& delta_iterations = delta_sim.sample_iterations;
+  const std::vector<unsigned>& ref_iterations = ref_sim.sample_iterations;
+
+  // Actors that did not collect data on every iteration cannot be paired
+  if ( delta.stored_samples() != delta_iterations.size() || ref.stored_samples() != ref_iterations.size() )
+  {
+    return -1.0;
+  }
+
+  std::vector<double> ref_values;
+  for ( size_t i = 0; i < ref_iterations.size(); ++i )
+  {
+    if ( ref_iterations[ i ] >= ref_values.size() )
+    {
+      ref_values.resize( ref_iterations[ i ] + 1, std::numeric_limits<double>::quiet_NaN() );
+    }
+    ref_values[ ref_iterations[ i ] ] = ref.sample( i );
+  }
+
+  running_stats_t differences;
+  for ( size_t i = 0; i < delta_iterations.size(); ++i )
+  {
+    unsigned iteration = delta_iterations[ i ];
+    if ( iteration < ref_values.size() && ! std::isnan( ref_values[ iteration ] ) )
+    {
+      differences.add( delta.sample( i ) - ref_values[ iteration ] );
+    }
+  }
+
+  if ( differences.count() < 2 )
+  {
+    return -1.0;
+  }
+
+  return differences.mean_std_dev();
+}
+
+// Delta and reference simulations of a single scale factor stat
+struct scale_stat_sims_t
+{
+  stat_e stat;
+  double scale_delta;
+  bool center;
+  sim_t* ref_sim;
+  sim_t* delta_sim;
+  int pending; // Number of unfinished simulations
+};
+
+// A delta or reference simulation of a stat
+struct scale_job_t
+{
+  size_t stat_index;
+  bool reference;
+};
+
 struct compare_scale_factors
 {
   player_t* player;
@@ -99,8 +162,7 @@ struct compare_scale_factors
 // scaling_t::scaling_t =====================================================
 
 scaling_t::scaling_t( sim_t* s ) :
-  sim( s ), baseline_sim( nullptr ), ref_sim( nullptr ), delta_sim( nullptr ), ref_sim2( nullptr ),
-  delta_sim2( nullptr ),
+  sim( s ), baseline_sim( nullptr ), ref_sim( nullptr ), delta_sim( nullptr ),
   scale_stat( STAT_NONE ),
   scale_value( 0 ),
   scale_delta_multiplier( 1.0 ),
@@ -111,9 +173,10 @@ scaling_t::scaling_t( sim_t* s ) :
   scale_factor_noise( 0.10 ),
   normalize_scale_factors( 0 ),
   debug_scale_factors( 0 ),
-  current_scaling_stat( STAT_NONE ),
+  scale_work_threads( 0 ),
   num_scaling_stats( 0 ),
   remaining_scaling_stats( 0 ),
+  active_sims(),
   scale_over(), scaling_metric( SCALE_METRIC_NONE ), scale_over_player()
 {
   create_options();
@@ -129,15 +192,29 @@ double scaling_t::progress( std::string& phase, std::string* detailed )
 
   if ( num_scaling_stats <= 0 ) return 0.0;
 
-  if ( current_scaling_stat <= 0 )
+  if ( active_sims.empty() && remaining_scaling_stats == num_scaling_stats )
   {
     phase = "Baseline";
     if ( ! baseline_sim ) return 0;
     return baseline_sim -> progress(detailed ).pct();
   }
 
+  // Several stats may be simulated concurrently, list all of them
   phase  = "Scaling - ";
-  phase += util::stat_type_abbrev( current_scaling_stat );
+  std::vector<stat_e> active_stats;
+  for ( const auto active_sim : active_sims )
+  {
+    stat_e stat = active_sim -> scaling -> scale_stat;
+    if ( range::find( active_stats, stat ) == active_stats.end() )
+    {
+      if ( ! active_stats.empty() )
+      {
+        phase += ", ";
+      }
+      phase += util::stat_type_abbrev( stat );
+      active_stats.push_back( stat );
+    }
+  }
 
   int completed_scaling_stats = ( num_scaling_stats - remaining_scaling_stats );
 
@@ -147,11 +224,10 @@ double scaling_t::progress( std::string& phase, std::string* detailed )
 
   double divisor = num_scaling_stats * 2.0;
 
-  if ( ref_sim  ) stat_progress += divisor * ref_sim  -> progress().pct();
-  if ( ref_sim2 ) stat_progress += divisor * ref_sim2 -> progress().pct();
-
-  if ( delta_sim  ) stat_progress += divisor * delta_sim  -> progress().pct();
-  if ( delta_sim2 ) stat_progress += divisor * delta_sim2 -> progress().pct();
+  for ( const auto active_sim : active_sims )
+  {
+    stat_progress += active_sim -> progress().pct() / divisor;
+  }
 
   return stat_progress;
 }
@@ -217,122 +293,221 @@ void scaling_t::analyze_stats()
   baseline_sim = sim; // Take the current sim as baseline
   mutex.unlock();
 
-  for ( size_t k = 0; k < stats_to_scale.size(); ++k )
+  // Each stat needs a delta simulation, and centered stats a separate reference simulation. All
+  // of them are independent jobs, run by scale_work_threads concurrent workers that each get an
+  // even share of the threads.
+  std::vector<scale_stat_sims_t> stat_sims;
+  std::vector<scale_job_t> jobs;
+  for ( stat_e stat : stats_to_scale )
   {
-    if ( sim -> is_canceled() ) break;
+    bool center = center_scale_delta && ! stat_may_cap( stat );
 
-    current_scaling_stat = stats_to_scale[ k ]; // Stat we're scaling over
-    const stat_e& stat = current_scaling_stat;
+    stat_sims.push_back( scale_stat_sims_t{ stat, stats.get_stat( stat ), center,
+                                            center ? nullptr : baseline_sim, nullptr, center ? 2 : 1 } );
+    jobs.push_back( scale_job_t{ stat_sims.size() - 1, false } );
+    if ( center )
+    {
+      jobs.push_back( scale_job_t{ stat_sims.size() - 1, true } );
+    }
+  }
 
-    double scale_delta = stats.get_stat( stat );
-    assert ( scale_delta );
+  int n_workers = std::max( 1, std::min( scale_work_threads, sim -> threads ) );
+  int job_threads = std::max( 1, sim -> threads / n_workers );
+  size_t next_job = 0;
 
-    bool center = center_scale_delta && ! stat_may_cap( stat );
+  auto worker = [ this, &stat_sims, &jobs, &next_job, job_threads ]( bool report_progress ) {
+    while ( true )
+    {
+      mutex.lock();
+      if ( sim -> is_canceled() || next_job == jobs.size() )
+      {
+        mutex.unlock();
+        return;
+      }
+      const scale_job_t& job = jobs[ next_job++ ];
+      mutex.unlock();
 
-    mutex.lock();
-    ref_sim = baseline_sim;
-    delta_sim = new sim_t( sim );
-    mutex.unlock();
+      scale_stat_sims_t& entry = stat_sims[ job.stat_index ];
+      double scale_delta = entry.scale_delta;
+      assert ( scale_delta );
 
-    delta_sim -> progress_bar.set_base( util::stat_type_abbrev( stat ) );
+      auto job_sim = new sim_t( sim );
 
-    delta_sim -> scaling -> scale_stat = stat;
-    delta_sim -> scaling -> scale_value = +scale_delta / ( center ? 2 : 1 );
-    delta_sim -> execute();
+      std::string base = util::stat_type_abbrev( entry.stat );
+      job_sim -> progress_bar.set_base( job.reference ? "Ref " + base : base );
+
+      job_sim -> threads = job_threads;
+      if ( ! report_progress )
+      {
+        job_sim -> report_progress = 0;
+      }
+
+      job_sim -> scaling -> scale_stat = entry.stat;
+      if ( job.reference )
+      {
+        job_sim -> scaling -> scale_value = -( scale_delta / 2 );
+      }
+      else
+      {
+        job_sim -> scaling -> scale_value = +scale_delta / ( entry.center ? 2 : 1 );
+      }
 
-    if ( center )
-    {
       mutex.lock();
-      ref_sim = new sim_t( sim );
+      active_sims.push_back( job_sim );
       mutex.unlock();
 
-      ref_sim -> progress_bar.set_base( std::string( "Ref " ) + util::stat_type_abbrev( stat ) );
+      job_sim -> execute();
+
+      // The last finished simulation of a stat computes the scale factors. Results of all stats
+      // are written to the same actors, so this is done under the lock.
+      AUTO_LOCK( mutex );
+
+      active_sims.erase( range::find( active_sims, job_sim ) );
+      if ( job.reference )
+      {
+        entry.ref_sim = job_sim;
+      }
+      else
+      {
+        entry.delta_sim = job_sim;
+      }
+
+      if ( --entry.pending > 0 )
+      {
+        continue;
+      }
 
-      ref_sim -> scaling -> scale_stat = stat;
-      ref_sim -> scaling -> scale_value = center ? -( scale_delta / 2 ) : 0;
-      ref_sim -> execute();
+      if ( ! sim -> is_canceled() )
+      {
+        analyze_stat( entry.stat, entry.scale_delta, entry.center, entry.ref_sim, entry.delta_sim );
+      }
+
+      if ( entry.ref_sim != baseline_sim && entry.ref_sim != sim )
+      {
+        delete entry.ref_sim;
+      }
+      delete entry.delta_sim;
+      entry.ref_sim = entry.delta_sim = nullptr;
+      remaining_scaling_stats--;
     }
+  };
+
+  // The calling thread acts as the first worker, and is the only one reporting progress
+  std::vector<std::unique_ptr<sc_task_thread_t>> workers;
+  for ( int i = 1; i < n_workers; ++i )
+  {
+    workers.emplace_back( new sc_task_thread_t( [ &worker ]() { worker( false ); } ) );
+    workers.back() -> launch();
+  }
+
+  worker( true );
+
+  for ( auto& t : workers )
+  {
+    t -> join();
+  }
 
-    for ( size_t j = 0; j < sim -> players_by_name.size(); j++ )
+  // Clean up simulations of stats that were not finished due to cancellation
+  for ( auto& entry : stat_sims )
+  {
+    if ( entry.pending > 0 )
     {
-      player_t* p = sim -> players_by_name[ j ];
+      if ( entry.ref_sim != baseline_sim )
+      {
+        delete entry.ref_sim;
+      }
+      delete entry.delta_sim;
+    }
+  }
 
-      if ( ! p -> scaling -> scales_with[ stat ] ) continue;
+  if ( baseline_sim != sim ) delete baseline_sim;
+  baseline_sim = nullptr;
+}
 
-      player_t*   ref_p =   ref_sim -> find_player( p -> name() );
-      player_t* delta_p = delta_sim -> find_player( p -> name() );
-      assert( ref_p && "Reference Player not found" );
-      assert( delta_p && "Delta player not found" );
+// scaling_t::analyze_stat ==================================================
 
-      double divisor = scale_delta;
+void scaling_t::analyze_stat( stat_e stat, double scale_delta, bool center, sim_t* ref_sim, sim_t* delta_sim )
+{
+  for ( size_t j = 0; j < sim -> players_by_name.size(); j++ )
+  {
+    player_t* p = sim -> players_by_name[ j ];
 
-      if ( delta_p -> invert_scaling )
-        divisor = -divisor;
+    if ( ! p -> scaling -> scales_with[ stat ] ) continue;
 
-      if ( divisor < 0.0 ) divisor += ref_p -> scaling -> over_cap[ stat ];
+    player_t*   ref_p =   ref_sim -> find_player( p -> name() );
+    player_t* delta_p = delta_sim -> find_player( p -> name() );
+    assert( ref_p && "Reference Player not found" );
+    assert( delta_p && "Delta player not found" );
 
-      for ( scale_metric_e sm = SCALE_METRIC_NONE; sm < SCALE_METRIC_MAX; sm++ )
-      {
+    double divisor = scale_delta;
 
-        double delta_score = delta_p -> scaling_for_metric( sm ).value;
-        double   ref_score = ref_p -> scaling_for_metric( sm ).value;
+    if ( delta_p -> invert_scaling )
+      divisor = -divisor;
 
-        double delta_error = delta_p -> scaling_for_metric( sm ).stddev * delta_sim -> confidence_estimator;
-        double   ref_error = ref_p -> scaling_for_metric( sm ).stddev * ref_sim -> confidence_estimator;
+    if ( divisor < 0.0 ) divisor += ref_p -> scaling -> over_cap[ stat ];
 
-        // TODO: this is the only place in the entire code base where scaling_delta_dps shows up, 
-        // apart from declaration in simulationcraft.hpp line 4535. Possible to remove?
-        p -> scaling -> scaling_delta_dps[ sm ].set_stat( stat, delta_score );
+    for ( scale_metric_e sm = SCALE_METRIC_NONE; sm < SCALE_METRIC_MAX; sm++ )
+    {
 
-        double score = ( delta_score - ref_score ) / divisor;
-        double error = delta_error * delta_error + ref_error * ref_error;
+      scaling_metric_data_t delta_data = delta_p -> scaling_for_metric( sm );
+      scaling_metric_data_t   ref_data = ref_p -> scaling_for_metric( sm );
 
-        if ( error > 0 )
-          error = sqrt( error );
+      double delta_score = delta_data.value;
+      double   ref_score = ref_data.value;
 
-        error = fabs( error / divisor );
+      double delta_error = delta_data.stddev * delta_sim -> confidence_estimator;
+      double   ref_error = ref_data.stddev * ref_sim -> confidence_estimator;
 
-        if ( fabs( divisor ) < 1.0 ) // For things like Weapon Speed, show the gain per 0.1 speed gain rather than every 1.0.
+      // TODO: this is the only place in the entire code base where scaling_delta_dps shows up, 
+      // apart from declaration in simulationcraft.hpp line 4535. Possible to remove?
+      p -> scaling -> scaling_delta_dps[ sm ].set_stat( stat, delta_score );
+
+      double score = ( delta_score - ref_score ) / divisor;
+      double error = delta_error * delta_error + ref_error * ref_error;
+
+      if ( error > 0 )
+        error = sqrt( error );
+
+      // With common random numbers, the error of the difference comes from the paired
+      // per-iteration differences, which is much smaller than that of independent sims
+      if ( sim -> correlated_sampling && delta_data.samples && ref_data.samples )
+      {
+        double paired_std_dev = paired_mean_std_dev( *delta_sim, *delta_data.samples,
+                                                     *ref_sim, *ref_data.samples );
+        if ( paired_std_dev >= 0 )
         {
-          score /= 10.0;
-          error /= 10.0;
-          delta_error /= 10.0;
+          error = paired_std_dev * delta_sim -> confidence_estimator;
         }
+      }
 
-        analyze_ability_stats( stat, divisor, p, ref_p, delta_p );
-
-        if ( center )
-          p -> scaling -> scaling_compare_error[ sm ].set_stat( stat, error );
-        else
-          p -> scaling -> scaling_compare_error[ sm ].set_stat( stat, delta_error / divisor );
+      error = fabs( error / divisor );
 
-        p -> scaling -> scaling[ sm ].set_stat( stat, score );
-        p -> scaling -> scaling_error[ sm ].set_stat( stat, error );
+      if ( fabs( divisor ) < 1.0 ) // For things like Weapon Speed, show the gain per 0.1 speed gain rather than every 1.0.
+      {
+        score /= 10.0;
+        error /= 10.0;
+        delta_error /= 10.0;
       }
-    }
 
-    if ( debug_scale_factors )
-    {
-      std::cout << "\nref_sim report for '" << util::stat_type_string( stat ) << "'..." << std::endl;
-      report::print_text( ref_sim, true );
-      std::cout << "\ndelta_sim report for '" << util::stat_type_string( stat ) << "'..." << std::endl;
-      report::print_text( delta_sim, true );
-    }
+      analyze_ability_stats( stat, divisor, p, ref_p, delta_p );
 
-    mutex.lock();
-    if ( ref_sim != baseline_sim && ref_sim != sim )
-    {
-      delete ref_sim;
-      ref_sim = nullptr;
+      if ( center )
+        p -> scaling -> scaling_compare_error[ sm ].set_stat( stat, error );
+      else
+        p -> scaling -> scaling_compare_error[ sm ].set_stat( stat, delta_error / divisor );
+
+      p -> scaling -> scaling[ sm ].set_stat( stat, score );
+      p -> scaling -> scaling_error[ sm ].set_stat( stat, error );
     }
-    delete delta_sim;  
-    delta_sim  = nullptr;
-    remaining_scaling_stats--;
-    mutex.unlock();
   }
 
-  if ( baseline_sim != sim ) delete baseline_sim;
-  baseline_sim = nullptr;
+  if ( debug_scale_factors )
+  {
+    std::cout << "\nref_sim report for '" << util::stat_type_string( stat ) << "'..." << std::endl;
+    report::print_text( ref_sim, true );
+    std::cout << "\ndelta_sim report for '" << util::stat_type_string( stat ) << "'..." << std::endl;
+    report::print_text( delta_sim, true );
+  }
 }
 
 /* Creates scale factors for stats_t objects
@@ -504,6 +679,7 @@ void scaling_t::create_options()
   sim->add_option(opt_bool("positive_scale_delta", positive_scale_delta));
   sim->add_option(opt_bool("scale_lag", scale_lag));
   sim->add_option(opt_float("scale_factor_noise", scale_factor_noise));
+  sim->add_option(opt_int("scale_work_threads", scale_work_threads));
   sim->add_option(opt_float("scale_strength", stats.attribute[ATTR_STRENGTH]));
   sim->add_option(opt_float("scale_agility", stats.attribute[ATTR_AGILITY]));
   sim->add_option(opt_float("scale_stamina", stats.attribute[ATTR_STAMINA]));
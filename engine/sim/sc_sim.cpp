@@ -662,6 +662,120 @@ bool parse_fight_style( sim_t*             sim,
 
   return true;
 }
+
+// parse_statistics_storage =================================================
+
+bool parse_statistics_storage( sim_t*             sim,
+                               const std::string& /* name */,
+                               const std::string& value )
+{
+  if ( util::str_compare_ci( value, "full" ) )
+  {
+    sim -> statistics_sketch = false;
+    sim -> statistics_compact = false;
+  }
+  else if ( util::str_compare_ci( value, "sketch" ) )
+  {
+    sim -> statistics_sketch = true;
+    sim -> statistics_compact = false;
+  }
+  else if ( util::str_compare_ci( value, "compact" ) )
+  {
+    sim -> statistics_sketch = false;
+    sim -> statistics_compact = true;
+  }
+  else
+  {
+    sim -> errorf( "Unknown statistics storage '%s', valid values are 'full', 'sketch' and 'compact'.",
+                   value.c_str() );
+    return false;
+  }
+
+  return true;
+}
+
+// parse_apl_compiler =======================================================
+
+bool parse_apl_compiler( sim_t*             sim,
+                         const std::string& /* name */,
+                         const std::string& value )
+{
+  if ( util::str_compare_ci( value, "off" ) || value == "0" )
+  {
+    sim -> apl_compiler = false;
+    sim -> apl_compiler_verify = false;
+  }
+  else if ( util::str_compare_ci( value, "on" ) || value == "1" )
+  {
+    sim -> apl_compiler = true;
+    sim -> apl_compiler_verify = false;
+  }
+  else if ( util::str_compare_ci( value, "verify" ) )
+  {
+    sim -> apl_compiler = true;
+    sim -> apl_compiler_verify = true;
+  }
+  else
+  {
+    sim -> errorf( "Unknown apl_compiler mode '%s', valid values are 'off', 'on' and 'verify'.",
+                   value.c_str() );
+    return false;
+  }
+
+  return true;
+}
+
+// parse_combat_length_sampling =============================================
+
+bool parse_combat_length_sampling( sim_t*             sim,
+                                   const std::string& /* name */,
+                                   const std::string& value )
+{
+  if ( util::str_compare_ci( value, "sweep" ) )
+  {
+    sim -> combat_length_sampling = COMBAT_LENGTH_SWEEP;
+  }
+  else if ( util::str_compare_ci( value, "stratified" ) )
+  {
+    sim -> combat_length_sampling = COMBAT_LENGTH_STRATIFIED;
+  }
+  else if ( util::str_compare_ci( value, "antithetic" ) )
+  {
+    sim -> combat_length_sampling = COMBAT_LENGTH_ANTITHETIC;
+  }
+  else
+  {
+    sim -> errorf( "Unknown combat length sampling '%s', valid values are 'sweep', 'stratified' and 'antithetic'.",
+                   value.c_str() );
+    return false;
+  }
+
+  return true;
+}
+
+// parse_event_queue ========================================================
+
+bool parse_event_queue( sim_t*             sim,
+                        const std::string& /* name */,
+                        const std::string& value )
+{
+  if ( util::str_compare_ci( value, "wheel" ) )
+  {
+    sim -> event_mgr.hierarchical_wheel = false;
+  }
+  else if ( util::str_compare_ci( value, "hierarchical" ) )
+  {
+    sim -> event_mgr.hierarchical_wheel = true;
+  }
+  else
+  {
+    sim -> errorf( "Unknown event_queue '%s', valid values are 'wheel' and 'hierarchical'", value.c_str() );
+    return false;
+  }
+
+  return true;
+}
+
 // parse_override_spell_data ================================================
 
 bool parse_override_spell_data( sim_t*             sim,
@@ -1332,6 +1446,7 @@ sim_t::sim_t( sim_t* p, int index ) :
   max_time( timespan_t::zero() ),
   expected_iteration_time( timespan_t::zero() ),
   vary_combat_length( 0.0 ),
+  combat_length_sampling( COMBAT_LENGTH_SWEEP ),
   current_iteration( -1 ),
   iterations( 0 ),
   canceled( 0 ),
@@ -1368,6 +1483,8 @@ sim_t::sim_t( sim_t* p, int index ) :
   regen_periodicity( timespan_t::from_seconds( 0.25 ) ),
   ignite_sampling_delta( timespan_t::from_seconds( 0.2 ) ),
   fixed_time( false ), optimize_expressions( false ),
+  memoize_expressions( false ), expr_generation( 1 ),
+  apl_compiler( false ), apl_compiler_verify( false ),
   current_slot( -1 ),
   optimal_raid( 0 ), log( 0 ), debug_each( 0 ), save_profiles( 0 ), default_actions( 0 ),
   normalized_stat( STAT_NONE ),
@@ -1387,6 +1504,8 @@ sim_t::sim_t( sim_t* p, int index ) :
   pvp_crit( false ),
   active_enemies( 0 ), active_allies( 0 ),
   _rng(), seed( 0 ), deterministic( 0 ), strict_work_queue( 0 ),
+  correlated_sampling( false ), seed_base( 0 ), global_iteration( 0 ), total_numbered_iterations( 0 ),
+  sample_iterations(),
   average_range( true ), average_gauss( false ),
   convergence_scale( 2 ),
   fight_style( "Patchwerk" ), add_waves( 0 ), overrides( overrides_t() ),
@@ -1408,7 +1527,7 @@ sim_t::sim_t( sim_t* p, int index ) :
   // Report
   report_precision(2), report_pets_separately( 0 ), report_targets( 1 ), report_details( 1 ), report_raw_abilities( 1 ),
   report_rng( 0 ), hosted_html( 0 ),
-  save_raid_summary( 0 ), save_gear_comments( 0 ), statistics_level( 1 ), separate_stats_by_actions( 0 ), report_raid_summary( 0 ), buff_uptime_timeline( 0 ),
+  save_raid_summary( 0 ), save_gear_comments( 0 ), statistics_level( 1 ), statistics_sketch( false ), statistics_compact( false ), separate_stats_by_actions( 0 ), report_raid_summary( 0 ), buff_uptime_timeline( 0 ),
   decorated_tooltips( -1 ),
   allow_potions( true ),
   allow_food( true ),
@@ -1422,7 +1541,7 @@ sim_t::sim_t( sim_t* p, int index ) :
   enable_dps_healing( false ),
   scaling_normalized( 1.0 ),
   // Multi-Threading
-  threads( 0 ), thread_index( index ), process_priority( computer_process::BELOW_NORMAL ),
+  threads( 0 ), thread_index( index ), merge_ready( false ), process_priority( computer_process::BELOW_NORMAL ),
   work_queue( new work_queue_t() ),
   spell_query(), spell_query_level( MAX_LEVEL ),
   pause_mutex( nullptr ),
@@ -1433,7 +1552,10 @@ sim_t::sim_t( sim_t* p, int index ) :
   disable_hotfixes( false ),
   display_bonus_ids( false ),
   profileset_metric( SCALE_METRIC_DPS ),
-  profileset_enabled( false )
+  profileset_enabled( false ),
+  profileset_work_threads( 0 ),
+  profileset_race_iterations( 0 ),
+  profileset_race_margin( 0 )
 {
   item_db_sources.assign( std::begin( default_item_db_sources ),
                           std::end( default_item_db_sources ) );
@@ -1462,8 +1584,9 @@ sim_t::sim_t( sim_t* p, int index ) :
     // Inherit 'plot' settings from parent because are set outside of the config file
     enchant = parent -> enchant;
 
-    // While we inherit the parent seed, it may get overwritten in sim_t::init
-    seed = parent -> seed;
+    // While we inherit the parent seed, it may get overwritten in sim_t::init. Sims seeded per
+    // iteration keep overwriting the seed, so they inherit the base seed instead.
+    seed = parent -> seed_per_iteration() ? parent -> seed_base : parent -> seed;
 
     parent -> add_relative( this );
   }
@@ -1485,11 +1608,52 @@ double sim_t::iteration_time_adjust() const
   if ( iterations <= 1 )
     return 1.0;
 
-  if ( current_iteration == 0 )
+  // The calibration iteration of a thread is not collected. Numbered iterations leave it out, so
+  // the iteration pairs below are made of two collected iterations.
+  if ( current_iteration == 0 || ( numbered_iterations() && global_iteration == CALIBRATION_ITERATION ) )
     return 1.0;
 
-  auto progress = work_queue -> progress();
-  return 1.0 + vary_combat_length * ( ( current_iteration % 2 ) ? 1 : -1 ) * progress.pct();
+  switch ( combat_length_sampling )
+  {
+    // Base 2 radical inverse of the iteration pair number, mirrored within the pair. Every aligned
+    // block of 2^k pairs visits each of 2^k equal strata on both sides of the base length exactly
+    // once, and every complete pair averages exactly to the base length. Only the last iteration
+    // is left unpaired, when the number of collected iterations is odd.
+    case COMBAT_LENGTH_STRATIFIED:
+    {
+      uint32_t r = global_iteration / 2;
+      r = ( r << 16 ) | ( r >> 16 );
+      r = ( ( r & 0x00ff00ffU ) << 8 ) | ( ( r & 0xff00ff00U ) >> 8 );
+      r = ( ( r & 0x0f0f0f0fU ) << 4 ) | ( ( r & 0xf0f0f0f0U ) >> 4 );
+      r = ( ( r & 0x33333333U ) << 2 ) | ( ( r & 0xccccccccU ) >> 2 );
+      r = ( ( r & 0x55555555U ) << 1 ) | ( ( r & 0xaaaaaaaaU ) >> 1 );
+      double u = r / 4294967296.0;
+      if ( global_iteration % 2 )
+        u = 1.0 - u;
+      return 1.0 + vary_combat_length * ( 2.0 * u - 1.0 );
+    }
+    // Iterations 2j and 2j + 1 mirror each other around the base length, so every complete pair
+    // averages exactly to it. The pair position is a hash of the shared base seed and j.
+    case COMBAT_LENGTH_ANTITHETIC:
+    {
+      double u = ( rng::stream_seed( seed_base, global_iteration / 2 ) >> 11 ) * ( 1.0 / 9007199254740992.0 );
+      if ( global_iteration % 2 )
+        u = 1.0 - u;
+      return 1.0 + vary_combat_length * ( 2.0 * u - 1.0 );
+    }
+    default:
+    {
+      // Numbered iterations sweep by their global number, so the sweep does not depend on the threads
+      if ( numbered_iterations() && total_numbered_iterations > 0 )
+      {
+        double pct = std::min( 1.0, static_cast<double>( global_iteration ) / total_numbered_iterations );
+        return 1.0 + vary_combat_length * ( ( global_iteration % 2 ) ? 1 : -1 ) * pct;
+      }
+
+      auto progress = work_queue -> progress();
+      return 1.0 + vary_combat_length * ( ( current_iteration % 2 ) ? 1 : -1 ) * progress.pct();
+    }
+  }
 }
 
 // sim_t::expected_max_time =================================================
@@ -1610,9 +1774,6 @@ void sim_t::reset()
   if ( debug )
     out_debug << "Resetting Simulator";
 
-  if( deterministic )
-    seed = rng().reseed();
-
   event_mgr.reset();
 
   expected_iteration_time = max_time * iteration_time_adjust();
@@ -1685,8 +1846,15 @@ void sim_t::combat_begin()
 
   reset();
 
-  // Debug seed needs to be done _after_ sim reset, because deterministic=1 will reseed in
-  // sim_t::reset()
+  // Iteration N uses the same random stream in every thread and in every related sim
+  if ( seed_per_iteration() )
+  {
+    seed = rng::stream_seed( seed_base, global_iteration );
+    rng().seed( seed );
+    rng().reset();
+  }
+
+  // Debug seed needs to be done _after_ the iteration is seeded
   if ( debug_seed.size() > 0 )
   {
     enable_debug_seed();
@@ -1892,10 +2060,15 @@ void sim_t::datacollection_end()
   total_absorb.add( iteration_absorb );
   raid_aps.add( current_time() != timespan_t::zero() ? iteration_absorb / current_time().total_seconds() : 0 );
 
-  if ( deterministic && report_iteration_data > 0 && current_iteration > 0 && current_time() > timespan_t::zero() )
+  if ( numbered_iterations() )
+  {
+    sample_iterations.push_back( global_iteration );
+  }
+
+  if ( deterministic && report_iteration_data > 0 && current_time() > timespan_t::zero() )
   {
     // TODO: Metric should be selectable
-    iteration_data_entry_t entry( iteration_dmg / current_time().total_seconds(), seed, current_iteration );
+    iteration_data_entry_t entry( iteration_dmg / current_time().total_seconds(), seed, global_iteration );
     for ( size_t i = 0, end = target_list.size(); i < end; ++i )
     {
       const player_t* t = target_list[ i ];
@@ -1955,14 +2128,13 @@ void sim_t::analyze_error()
     auto p = player_no_pet_list[ current_index ];
     auto& cd = p -> collected_data;
     AUTO_LOCK( cd.target_metric_mutex );
-    if ( cd.target_metric.size() != 0 )
+    const auto& stats = cd.target_metric.running_stats();
+    if ( stats.count() != 0 )
     {
-      cd.target_metric.analyze_basics();
-      cd.target_metric.analyze_variance();
-      current_mean = cd.target_metric.mean();
+      current_mean = stats.mean();
       if ( current_mean != 0 )
       {
-        current_error = sim_t::distribution_mean_error( *this, cd.target_metric ) / current_mean;
+        current_error = sim_t::distribution_mean_error( *this, stats ) / current_mean;
       }
     }
   }
@@ -1973,14 +2145,13 @@ void sim_t::analyze_error()
       player_t* p = actor_list[i];
       player_collected_data_t& cd = p -> collected_data;
       AUTO_LOCK( cd.target_metric_mutex );
-      if ( cd.target_metric.size() != 0 )
+      const auto& stats = cd.target_metric.running_stats();
+      if ( stats.count() != 0 )
       {
-        cd.target_metric.analyze_basics();
-        cd.target_metric.analyze_variance();
-        double mean = cd.target_metric.mean();
+        double mean = stats.mean();
         if ( mean != 0 )
         {
-          double error = sim_t::distribution_mean_error( *this, cd.target_metric ) / mean;
+          double error = sim_t::distribution_mean_error( *this, stats ) / mean;
           if ( error > current_error ) current_error = error;
           mean_total += mean;
           mean_count++;
@@ -2360,6 +2531,7 @@ bool sim_t::init()
       seed  = uint64_t(rd()) | (uint64_t(rd()) << 32);
     }
   }
+  seed_base = seed;
   _rng = rng::create( rng::parse_type( rng_str ) );
   _rng -> seed( seed + thread_index );
 
@@ -2598,8 +2770,27 @@ bool sim_t::iterate()
   activate_actors();
 
   bool more_work = true;
+  bool calibrated = false;
   do
   {
+    // Numbered iterations get their number before they start. The numbers are handed out
+    // up to the total work, so every iteration is simulated exactly once regardless of the threads.
+    // The first iteration of a thread only calibrates (its data is not collected), it uses the same
+    // out of range number in every thread and is not part of the work.
+    bool calibration = false;
+    if ( numbered_iterations() )
+    {
+      if ( current_iteration < 0 && iterations > 1 )
+      {
+        global_iteration = CALIBRATION_ITERATION;
+        calibration = calibrated = ! single_actor_batch;
+      }
+      else if ( ! work_queue -> next_iteration( global_iteration ) && ! single_actor_batch )
+      {
+        break;
+      }
+    }
+
     ++current_iteration;
     ++work_done;
 
@@ -2614,7 +2805,10 @@ bool sim_t::iterate()
     auto old_active = current_index;
     if ( ! canceled )
     {
-      current_index = work_queue -> pop();
+      if ( ! calibration )
+      {
+        current_index = work_queue -> pop();
+      }
       more_work = work_queue -> more_work();
 
       if ( more_work && current_index != old_active )
@@ -2651,8 +2845,13 @@ bool sim_t::iterate()
   reset();
 
   iterations = current_iteration + 1;
+  if ( calibrated )
+  {
+    iterations--;
+  }
 
-  return iterations > 0;
+  // A thread may find all numbered iterations taken by the other threads
+  return iterations > 0 || ( numbered_iterations() && ! canceled );
 }
 
 /**
@@ -2695,7 +2894,12 @@ void sim_t::merge( sim_t& other_sim )
   }
 
   iterations += other_sim.iterations;
-  work_per_thread[ other_sim.thread_index ] = other_sim.work_done;
+  // The other sim may already hold the results of other threads (see sim_t::run)
+  other_sim.work_per_thread[ other_sim.thread_index ] = other_sim.work_done;
+  for ( size_t i = 0; i < work_per_thread.size() && i < other_sim.work_per_thread.size(); ++i )
+  {
+    work_per_thread[ i ] += other_sim.work_per_thread[ i ];
+  }
 
   simulation_length.merge( other_sim.simulation_length );
   total_dmg.merge( other_sim.total_dmg );
@@ -2722,6 +2926,7 @@ void sim_t::merge( sim_t& other_sim )
   }
 
   range::append( iteration_data, other_sim.iteration_data );
+  range::append( sample_iterations, other_sim.sample_iterations );
 }
 
 /// merge all sims together
@@ -2752,10 +2957,34 @@ void sim_t::merge()
 
 void sim_t::run()
 {
-  if( iterate() )
+  bool success = iterate();
+
+  // Thread results are merged in a binary tree, so the merge depth is logarithmic in the number
+  // of threads. Thread i merges threads i + 2^k ( 2^k < lowest set bit of i ) as they finish, and
+  // threads that are a power of two merge their subtree into the parent.
+  int lowest_bit = thread_index & -thread_index;
+  for ( int step = 1; step < lowest_bit; step <<= 1 )
+  {
+    size_t sibling_index = thread_index + step;
+    if ( sibling_index > parent -> children.size() )
+    {
+      break;
+    }
+
+    sim_t* sibling = parent -> children[ sibling_index - 1 ];
+    sibling -> join();
+    if ( success && sibling -> merge_ready )
+    {
+      merge( *sibling );
+    }
+  }
+
+  if ( success && thread_index == lowest_bit )
   {
     parent -> merge( *this );
   }
+
+  merge_ready = success;
 }
 
 // sim_t::partition =========================================================
@@ -2763,35 +2992,96 @@ void sim_t::run()
 void sim_t::partition()
 {
   iterations = work_queue -> size();
+  // Sims continuing the iteration numbering of earlier sims (racing profileset rounds) may set a
+  // larger total up front
+  total_numbered_iterations = std::max( total_numbered_iterations,
+                                        work_queue -> first_iteration() + static_cast<unsigned>( iterations ) );
 
-  if ( threads <= 1 )
-    return;
-  if ( iterations < threads )
+  // Every thread of a numbered sim gets more than one iteration, so that all threads calibrate
+  int min_iterations = numbered_iterations() && ! single_actor_batch ? 2 * threads : threads;
+  if ( threads <= 1 || iterations < min_iterations )
+  {
     return;
+  }
 
   thread::set_main_thread_priority();
 
+  // Numbered iterations need the same base seed in all threads, resolve it before the children are
+  // created
+  if ( numbered_iterations() )
+  {
+    if ( seed == 0 && ! deterministic )
+    {
+      std::random_device rd;
+      seed  = uint64_t(rd()) | (uint64_t(rd()) << 32);
+    }
+    seed_base = seed;
+  }
+
   merge_mutex.lock(); // parent sim is locked until parent merge() is called
 
   int remainder = iterations % threads;
   iterations /= threads;
 
-  // Normally we use a shared work-queue to ensure proper load balancing among threads.
-  // However, when we desire deterministic runs (for debugging) we need to force the
-  // sims to each use a specific number of iterations as opposed to using shared pool of work.
+  // Normally we use a shared work-queue to ensure proper load balancing among threads. Strict
+  // work queues force the sims to each use a specific number of iterations as opposed to using
+  // shared pool of work.
 
-  if ( deterministic || strict_work_queue )
+  if ( strict_work_queue )
   {
     work_queue -> init( iterations );
   }
 
   int num_children = threads - 1;
 
+  // Set up the child simulators concurrently as tasks of the process-wide thread pool. Each child
+  // parses the parent's control and creates its actors; the (more expensive) actor initialization
+  // is done by each child thread in sim_t::iterate.
+  std::vector<sim_t*> built( num_children, nullptr );
+  std::vector<std::exception_ptr> errors( num_children );
+  std::vector<std::unique_ptr<sc_task_thread_t>> builders;
   for ( int i = 0; i < num_children; i++ )
   {
-    auto  child = new sim_t( this, i + 1 );
-    assert( child );
-    children.push_back( child );
+    builders.emplace_back( new sc_task_thread_t( [ this, i, &built, &errors ]() {
+      try
+      {
+        built[ i ] = new sim_t( this, i + 1 );
+      }
+      catch ( ... )
+      {
+        errors[ i ] = std::current_exception();
+      }
+    } ) );
+    builders.back() -> launch();
+  }
+
+  std::exception_ptr error;
+  for ( int i = 0; i < num_children; i++ )
+  {
+    builders[ i ] -> join();
+    if ( built[ i ] )
+    {
+      children.push_back( built[ i ] );
+    }
+    else if ( ! error )
+    {
+      error = errors[ i ];
+    }
+  }
+
+  if ( error )
+  {
+    merge_mutex.unlock();
+    range::dispose( children );
+    children.clear();
+    std::rethrow_exception( error );
+  }
+
+  // Strict work queues number their iterations consecutively after the previous thread
+  unsigned first_iteration = work_queue -> first_iteration() + iterations;
+  for ( int i = 0; i < num_children; i++ )
+  {
+    auto child = children[ i ];
 
     child -> iterations = iterations;
     if ( remainder )
@@ -2799,10 +3089,13 @@ void sim_t::partition()
       child -> iterations += 1;
       remainder--;
     }
+    child -> total_numbered_iterations = total_numbered_iterations;
 
-    if( deterministic || strict_work_queue )
+    if( strict_work_queue )
     {
       child -> work_queue -> init( child -> iterations );
+      child -> work_queue -> first_iteration( first_iteration );
+      first_iteration += child -> iterations;
     }
     else // share the work queue
     {
@@ -3082,6 +3375,7 @@ void sim_t::create_options()
   add_option( opt_timespan( "max_time", max_time, timespan_t::zero(), timespan_t::max() ) );
   add_option( opt_bool( "fixed_time", fixed_time ) );
   add_option( opt_float( "vary_combat_length", vary_combat_length, 0.0, 1.0 ) );
+  add_option( opt_func( "combat_length_sampling", parse_combat_length_sampling ) );
   add_option( opt_func( "ptr", parse_ptr ) );
   add_option( opt_int( "threads", threads ) );
   add_option( opt_float( "confidence", confidence, 0.0, 1.0 ) );
@@ -3093,6 +3387,8 @@ void sim_t::create_options()
   add_option( opt_int( "stat_cache", stat_cache ) );
   add_option( opt_int( "max_aoe_enemies", max_aoe_enemies ) );
   add_option( opt_bool( "optimize_expressions", optimize_expressions ) );
+  add_option( opt_bool( "memoize_expressions", memoize_expressions ) );
+  add_option( opt_func( "apl_compiler", parse_apl_compiler ) );
   add_option( opt_bool( "single_actor_batch", single_actor_batch ) );
   add_option( opt_bool( "progressbar_type", progressbar_type ) );
   // Raid buff overrides
@@ -3151,6 +3447,7 @@ void sim_t::create_options()
   // RNG
   add_option( opt_string( "rng", rng_str ) );
   add_option( opt_bool( "deterministic", deterministic ) );
+  add_option( opt_bool( "correlated_sampling", correlated_sampling ) );
   add_option( opt_bool( "strict_work_queue", strict_work_queue ) );
   add_option( opt_float( "report_iteration_data", report_iteration_data ) );
   add_option( opt_int( "min_report_iteration_data", min_report_iteration_data ) );
@@ -3164,6 +3461,7 @@ void sim_t::create_options()
   add_option( opt_float( "wheel_granularity", event_mgr.wheel_granularity ) );
   add_option( opt_int( "wheel_seconds", event_mgr.wheel_seconds ) );
   add_option( opt_int( "wheel_shift", event_mgr.wheel_shift ) );
+  add_option( opt_func( "event_queue", parse_event_queue ) );
   add_option( opt_string( "reference_player", reference_player_str ) );
   add_option( opt_string( "raid_events", raid_events_str ) );
   add_option( opt_append( "raid_events+", raid_events_str ) );
@@ -3253,6 +3551,7 @@ void sim_t::create_options()
   add_option( opt_bool( "report_raw_abilities", report_raw_abilities ) );
   add_option( opt_bool( "report_rng", report_rng ) );
   add_option( opt_int( "statistics_level", statistics_level ) );
+  add_option( opt_func( "statistics_storage", parse_statistics_storage ) );
   add_option( opt_bool( "separate_stats_by_actions", separate_stats_by_actions ) );
   add_option( opt_bool( "report_raid_summary", report_raid_summary ) ); // Force reporting of raid summary
   add_option( opt_string( "reforge_plot_output_file", reforge_plot_output_file_str ) );
@@ -3456,15 +3755,19 @@ void sim_t::setup( sim_control_t* c )
     work_queue -> batches( player_no_pet_list.size() );
   }
   work_queue -> init( iterations );
-  if ( thread_index == 0 )
-  {
-    work_per_thread.resize( threads );
-  }
+  work_per_thread.resize( threads );
 
   if( deterministic && ( target_error != 0 ) )
   {
     errorf( "deterministic=1 cannot be used with non-zero target_error values!\n" );
   }
+
+  // Iteration numbers are not tracked per actor batch, so deterministic single actor batch sims
+  // still split the iterations statically between the threads
+  if ( deterministic && single_actor_batch )
+  {
+    strict_work_queue = 1;
+  }
 }
 
 // sim_t::progress ==========================================================
@@ -3481,7 +3784,7 @@ sim_progress_t sim_t::progress( std::string* detailed, int index )
   }
 
   // For work queues that are independent, collect all work done so far for the progressbar.
-  if ( deterministic || strict_work_queue )
+  if ( strict_work_queue )
   {
     AUTO_LOCK( relatives_mutex );
     for ( const auto& child : children )
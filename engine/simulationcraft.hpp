@@ -1319,9 +1319,11 @@ struct progress_bar_t
   double start_time, last_update, max_interval_time;
   std::string status;
   std::string base_str, phase_str;
-  size_t work_index, total_work_;
+  std::atomic<size_t> work_index;
+  size_t total_work_;
   double elapsed_time;
   size_t time_count;
+  mutable mutex_t time_mutex;
 
   progress_bar_t( sim_t& s );
   void init();
@@ -1359,6 +1361,7 @@ struct vector_with_callback
 private:
   std::vector<T> _data;
   std::vector<std::function<void(T)> > _callbacks ;
+  uint64_t _generation = 0;
 public:
   /* Register your custom callback, which will be called when the vector is modified
    */
@@ -1386,7 +1389,7 @@ public:
   }
 
   void push_back( T x )
-  { _data.push_back( x ); trigger_callbacks( x ); }
+  { _data.push_back( x ); ++_generation; trigger_callbacks( x ); }
 
   void find_and_erase( T x )
   {
@@ -1418,6 +1421,12 @@ public:
   bool empty() const
   { return _data.empty(); }
 
+  /* Incremented on every modification made through this class, so users holding a snapshot of
+   * the vector can cheaply tell whether it is still current.
+   */
+  uint64_t generation() const
+  { return _generation; }
+
   void reset_callbacks()
   { _callbacks.clear(); }
 
@@ -1426,6 +1435,7 @@ private:
   {
     T _v = *it;
     ::erase_unordered( _data, it );
+    ++_generation;
     trigger_callbacks( _v );
   }
 
@@ -1433,6 +1443,7 @@ private:
   {
     T _v = *it;
     _data.erase( it );
+    ++_generation;
     trigger_callbacks( _v );
   }
 };
@@ -1492,47 +1503,129 @@ private:
 #define ACTOR_EVENT_BOOKKEEPING 0
 #endif
 
+// CPU Profiling ============================================================
+
+/// Thread cpu time and call count of a profiled code path (monitor_cpu=1)
+struct cpu_profile_t
+{
+  enum action_phase_e { EXECUTE, IMPACT, TICK, ACTION_PHASE_MAX };
+
+  std::string category;
+  std::string name;
+  stopwatch_t stopwatch;
+  uint64_t count;
+
+  cpu_profile_t() : stopwatch( STOPWATCH_THREAD ), count( 0 )
+  { }
+
+  void merge( const cpu_profile_t& other )
+  {
+    stopwatch += other.stopwatch;
+    count += other.count;
+  }
+};
+
+/// Accumulate the time spent in the enclosing scope to a (optional) profile
+struct cpu_profile_scope_t
+{
+  cpu_profile_t* profile;
+
+  cpu_profile_scope_t( cpu_profile_t* p ) : profile( p )
+  {
+    if ( profile )
+      profile -> stopwatch.mark();
+  }
+
+  ~cpu_profile_scope_t()
+  {
+    if ( profile )
+    {
+      profile -> stopwatch.accumulate();
+      profile -> count++;
+    }
+  }
+};
+
 // Event Manager ============================================================
 
 struct event_manager_t
 {
+  // Event memory size classes, 64 to 1024 byte blocks. Larger events get a
+  // heap block of their own, tracked in an extra "oversize" slot at index
+  // EVENT_SIZE_CLASSES of the per-class arrays below.
+  static const unsigned EVENT_SIZE_CLASSES = 5;
+
   sim_t* sim;
   timespan_t current_time;
   uint64_t events_remaining;
   uint64_t events_processed;
   uint64_t total_events_processed;
+  uint64_t total_events_executed;
+  uint64_t total_events_canceled;
   uint64_t max_events_remaining;
+  uint64_t expr_memo_hits, expr_memo_evaluations;
   unsigned timing_slice, global_event_id;
   std::vector<event_t*> timing_wheel;
-  event_t* recycled_event_list;
+  std::array<event_t*, EVENT_SIZE_CLASSES + 1> recycled_event_list;
+  std::array<char*, EVENT_SIZE_CLASSES> chunk_cursor, chunk_end;
+  std::vector<char*> event_chunks;
   int    wheel_seconds, wheel_size, wheel_mask, wheel_shift;
   double wheel_granularity;
   timespan_t wheel_time;
   std::vector<event_t*> allocated_events;
+  // Canceled events, unlinked from the queue but not recycled until their
+  // scheduled time, so stale pointers to them stay harmless. Min-heap on time.
+  std::vector<event_t*> canceled_events;
+  std::array<uint64_t, EVENT_SIZE_CLASSES + 1> n_requested_events, n_allocated_events;
+
+  // Hierarchical timing wheel (event_queue=hierarchical). Level 0 has 1ms
+  // buckets, so each bucket only holds events of a single timestamp and
+  // insertion is a FIFO append. Higher levels are cascaded downwards as the
+  // wheel turns.
+  struct wheel_bucket_t
+  {
+    event_t* head;
+    event_t* tail;
+  };
+  bool hierarchical_wheel;
+  uint64_t hwheel_time;
+  std::vector<wheel_bucket_t> hwheel;
+  std::array<uint64_t, 8> hwheel_occupancy;
+  wheel_bucket_t hwheel_overflow;
 
   stopwatch_t event_stopwatch;
   bool monitor_cpu;
+  std::map<std::string, cpu_profile_t> cpu_profile;
+  std::unordered_map<const char*, cpu_profile_t*> event_profile;
   bool canceled;
 #ifdef EVENT_QUEUE_DEBUG
-  unsigned max_queue_depth, n_allocated_events, n_end_insert, n_requested_events;
+  unsigned max_queue_depth, n_end_insert;
   uint64_t events_traversed, events_added;
   std::vector<std::pair<unsigned, unsigned> > event_queue_depth_samples;
-  std::vector<unsigned> event_requested_size_count;
 #endif /* EVENT_QUEUE_DEBUG */
 
   event_manager_t( sim_t* );
  ~event_manager_t();
+  static std::size_t event_block_size( unsigned size_class );
   void* allocate_event( std::size_t size );
   void recycle_event( event_t* );
   void add_event( event_t*, timespan_t delta_time );
+  void remove_event( event_t* );
+  void release_canceled_events();
   void reschedule_event( event_t* );
   event_t* next_event();
+  wheel_bucket_t& hwheel_bucket( const event_t*, uint64_t*& occupancy, uint64_t& bit );
+  void hwheel_insert( event_t* );
+  void hwheel_cascade( unsigned level, unsigned index );
+  event_t* hwheel_next_event();
   bool execute();
   void cancel();
   void flush();
   void init();
   void reset();
   void merge( event_manager_t& other );
+  cpu_profile_t& profile( const std::string& category, const std::string& name );
+  std::vector<const cpu_profile_t*> sorted_cpu_profile() const;
 };
 
 // Simulation Engine ========================================================
@@ -1550,6 +1643,7 @@ struct sim_t : private sc_thread_t
   // Iteration Controls
   timespan_t max_time, expected_iteration_time;
   double vary_combat_length;
+  combat_length_sampling_e combat_length_sampling;
   int current_iteration, iterations;
   bool canceled;
   double target_error;
@@ -1591,6 +1685,9 @@ struct sim_t : private sc_thread_t
   timespan_t  reaction_time, regen_periodicity;
   timespan_t  ignite_sampling_delta;
   bool        fixed_time, optimize_expressions;
+  bool        memoize_expressions; // Share expression leaf values within an expression generation
+  uint64_t    expr_generation; // Bumped by every event and by state mutations visible to expressions
+  bool        apl_compiler, apl_compiler_verify; // Compiled action priority lists and conditions, optionally checked against the tree
   int         current_slot;
   int         optimal_raid, log, debug_each;
   std::vector<uint64_t> debug_seed;
@@ -1657,6 +1754,16 @@ struct sim_t : private sc_thread_t
   uint64_t seed;
   int deterministic;
   int strict_work_queue;
+  // Deterministic and correlated sims derive the seed of each iteration from ( seed_base, global
+  // iteration number ). Results do not depend on which thread simulates an iteration, and related
+  // sims (scale factors, plots) share their random streams with correlated_sampling. The first
+  // (calibration) iteration of each thread is not collected, not numbered and not counted.
+  bool correlated_sampling;
+  uint64_t seed_base;
+  unsigned global_iteration;
+  unsigned total_numbered_iterations; // Requested iterations of all threads (and racing rounds)
+  static const unsigned CALIBRATION_ITERATION = ~0U; // Number of the calibration iteration in all threads
+  std::vector<unsigned> sample_iterations; // Global iteration number of each collected (numbered) sample
   int average_range, average_gauss;
   int convergence_scale;
 
@@ -1769,6 +1876,8 @@ struct sim_t : private sc_thread_t
   int save_raid_summary;
   int save_gear_comments;
   int statistics_level;
+  bool statistics_sketch; // Store sample data in bounded memory quantile sketches
+  bool statistics_compact; // Store sample data as 32bit floats
   int separate_stats_by_actions;
   int report_raid_summary;
   int buff_uptime_timeline;
@@ -1791,82 +1900,128 @@ struct sim_t : private sc_thread_t
   int threads;
   std::vector<sim_t*> children; // Manual delete!
   int thread_index;
+  bool merge_ready; // Thread child finished iterating, and holds results of its merge subtree
   computer_process::priority_e process_priority;
+  // Shared iteration work queue. All state is kept in atomics, so threads claim iterations with a
+  // single compare-and-swap instead of serializing on a mutex. Batches (single actor batch) are
+  // only set up before the simulator threads are launched.
   struct work_queue_t
   {
     private:
-    mutex_t m;
+    std::vector<std::atomic<int>> _total_work, _work, _projected_work;
+    std::atomic<size_t> index;
+    std::atomic<unsigned> iteration; // Global number of the next iteration to start
+    unsigned first;
+
+    // Move on to the next batch, if nobody else did already
+    void advance( size_t idx )
+    {
+      if ( idx < _work.size() - 1 )
+      {
+        index.compare_exchange_strong( idx, idx + 1 );
+      }
+    }
+
     public:
-    std::vector<int> _total_work, _work, _projected_work;
-    size_t index;
+    work_queue_t() : index( 0 ), iteration( 0 ), first( 0 )
+    { batches( 1 ); }
 
-    work_queue_t() : index( 0 )
-    { _total_work.resize( 1 ); _work.resize( 1 ); _projected_work.resize( 1 ); }
+    // Number the iterations of this queue from n on (strict work queues of child threads, racing
+    // profileset rounds)
+    void first_iteration( unsigned n )
+    { first = n; iteration.store( n ); }
 
-    void init( int w )    { AUTO_LOCK(m); range::fill( _total_work, w ); range::fill( _projected_work, w ); }
-    // Single actor batch sim init methods. Batches is the number of active actors
-    void batches( size_t n ) { AUTO_LOCK(m); _total_work.resize( n ); _work.resize( n ); _projected_work.resize( n ); }
+    unsigned first_iteration() const
+    { return first; }
 
-    void flush()          { AUTO_LOCK(m); _total_work[ index ] = _projected_work[ index ] = _work[ index ]; }
-    int  size()           { AUTO_LOCK(m); return index < _total_work.size() ? _total_work[ index ] : _total_work.back(); }
-    bool more_work()      { AUTO_LOCK(m); return index < _total_work.size() && _work[ index ] < _total_work[ index ]; }
+    // Unique number of a newly started iteration, among all threads sharing the queue. Returns
+    // false once all iterations of the queue have been started.
+    bool next_iteration( unsigned& n )
+    {
+      n = iteration.fetch_add( 1 );
+      return n < first + static_cast<unsigned>( size() );
+    }
 
-    void project( int w )
+    void init( int w )
     {
-      AUTO_LOCK(m);
-      _projected_work[ index ] = w;
-#ifdef NDEBUG
-      if ( w > _work[ index ] )
+      for ( size_t i = 0; i < _total_work.size(); ++i )
       {
+        _total_work[ i ].store( w );
+        _projected_work[ i ].store( w );
       }
-#endif
     }
 
+    // Single actor batch sim init methods. Batches is the number of active actors
+    void batches( size_t n )
+    {
+      _total_work = std::vector<std::atomic<int>>( n );
+      _work = std::vector<std::atomic<int>>( n );
+      _projected_work = std::vector<std::atomic<int>>( n );
+    }
+
+    void flush()
+    {
+      size_t idx = index.load();
+      int w = _work[ idx ].load();
+      _total_work[ idx ].store( w );
+      _projected_work[ idx ].store( w );
+    }
+
+    int size()
+    { return _total_work[ index.load( std::memory_order_relaxed ) ].load( std::memory_order_relaxed ); }
+
+    bool more_work()
+    {
+      size_t idx = index.load( std::memory_order_relaxed );
+      return _work[ idx ].load( std::memory_order_relaxed ) <
+             _total_work[ idx ].load( std::memory_order_relaxed );
+    }
+
+    void project( int w )
+    { _projected_work[ index.load( std::memory_order_relaxed ) ].store( w, std::memory_order_relaxed ); }
+
     // Single-actor batch pop, uses several indices of work (per active actor), each thread has it's
     // own state on what index it is simulating
     size_t pop()
     {
-      AUTO_LOCK(m);
+      size_t idx = index.load();
+      int w = _work[ idx ].load();
 
-      if ( _work[ index ] >= _total_work[ index ] )
+      do
       {
-        if ( index < _work.size() - 1 )
+        if ( w >= _total_work[ idx ].load() )
         {
-          ++index;
+          advance( idx );
+          return index.load();
         }
-        return index;
-      }
+      } while ( ! _work[ idx ].compare_exchange_weak( w, w + 1 ) );
 
-      if ( ++_work[ index ] == _total_work[ index ] )
+      if ( w + 1 == _total_work[ idx ].load() )
       {
-        _projected_work[ index ] = _work[ index ];
-        if ( index < _work.size() - 1 )
-        {
-          ++index;
-        }
-        return index;
+        _projected_work[ idx ].store( w + 1 );
+        advance( idx );
       }
 
-      return index;
+      return index.load();
     }
 
     // Standard progress method, normal mode sims use the single (first) index, single actor batch
     // sims progress with the main thread's current index.
     sim_progress_t progress( int idx = -1 )
     {
-      AUTO_LOCK(m);
       size_t current_index = idx;
       if ( idx < 0 )
       {
-        current_index = index;
+        current_index = index.load( std::memory_order_relaxed );
       }
 
       if ( current_index >= _total_work.size() )
       {
-        return sim_progress_t{ _work.back(), _projected_work.back() };
+        current_index = _total_work.size() - 1;
       }
 
-      return sim_progress_t{ _work[ current_index ], _projected_work[ current_index ] };
+      return sim_progress_t{ _work[ current_index ].load( std::memory_order_relaxed ),
+                             _projected_work[ current_index ].load( std::memory_order_relaxed ) };
     }
   };
   std::shared_ptr<work_queue_t> work_queue;
@@ -1908,6 +2063,9 @@ struct sim_t : private sc_thread_t
   profileset::profilesets_t profilesets;
   scale_metric_e profileset_metric;
   bool profileset_enabled;
+  int profileset_work_threads;
+  int profileset_race_iterations; // Iterations per racing round, 0 disables racing
+  double profileset_race_margin;  // Elimination margin in percent of the best mean
 
   sim_t( sim_t* parent = nullptr, int thread_index = 0 );
   virtual ~sim_t();
@@ -1966,8 +2124,15 @@ struct sim_t : private sc_thread_t
 
   timespan_t current_time() const
   { return event_mgr.current_time; }
+  bool seed_per_iteration() const
+  { return deterministic || correlated_sampling; }
+  // Iterations carry a global number, shared by all threads
+  bool numbered_iterations() const
+  { return seed_per_iteration() || combat_length_sampling != COMBAT_LENGTH_SWEEP; }
   static double distribution_mean_error( const sim_t& s, const extended_sample_data_t& sd )
   { return s.confidence_estimator * sd.mean_std_dev; }
+  static double distribution_mean_error( const sim_t& s, const running_stats_t& rs )
+  { return s.confidence_estimator * rs.mean_std_dev(); }
   void register_target_data_initializer(std::function<void(actor_target_data_t*)> cb)
   { target_data_initializer.push_back( cb ); }
   rng::rng_t& rng() const
@@ -2069,8 +2234,6 @@ struct scaling_t
   sim_t* baseline_sim;
   sim_t* ref_sim;
   sim_t* delta_sim;
-  sim_t* ref_sim2;
-  sim_t* delta_sim2;
   stat_e scale_stat;
   double scale_value;
   double scale_delta_multiplier;
@@ -2082,8 +2245,9 @@ struct scaling_t
   int    normalize_scale_factors;
   int    debug_scale_factors;
   std::string scale_only_str;
-  stat_e current_scaling_stat;
+  int scale_work_threads; // Number of stats simulated concurrently
   int num_scaling_stats, remaining_scaling_stats;
+  std::vector<sim_t*> active_sims; // Delta and reference sims currently executing
   std::string scale_over;
   scale_metric_e scaling_metric;
   std::string scale_over_player;
@@ -2096,6 +2260,7 @@ struct scaling_t
   void init_deltas();
   void analyze();
   void analyze_stats();
+  void analyze_stat( stat_e, double scale_delta, bool center, sim_t* ref_sim, sim_t* delta_sim );
   void analyze_ability_stats( stat_e, double, player_t*, player_t*, player_t* );
   void analyze_lag();
   void normalize();
@@ -2179,12 +2344,14 @@ struct event_t : private noncopyable
 {
   sim_t& _sim;
   event_t*    next;
+  event_t*    prev;
   timespan_t  time;
   timespan_t  reschedule_time;
   unsigned    id;
   bool        canceled;
   bool        recycled;
   bool scheduled;
+  bool queued;
 #if ACTOR_EVENT_BOOKKEEPING
   actor_t*    actor;
 #endif
@@ -3745,12 +3912,13 @@ struct scaling_metric_data_t {
   std::string name;
   double value, stddev;
   scale_metric_e metric;
+  const extended_sample_data_t* samples; // Per-iteration samples of the metric, if available
   scaling_metric_data_t( scale_metric_e m, const std::string& n, double v, double dev ) :
-    name( n ), value( v ), stddev( dev ), metric( m ) {}
+    name( n ), value( v ), stddev( dev ), metric( m ), samples( nullptr ) {}
   scaling_metric_data_t( scale_metric_e m, const extended_sample_data_t& sd ) :
-    name( sd.name_str ), value( sd.mean() ), stddev( sd.mean_std_dev ), metric( m ) {}
+    name( sd.name_str ), value( sd.mean() ), stddev( sd.mean_std_dev ), metric( m ), samples( &sd ) {}
   scaling_metric_data_t( scale_metric_e m, const sc_timeline_t& tl, const std::string& name ) :
-    name( name ), value( tl.mean() ), stddev( tl.mean_stddev() ), metric( m ) {}
+    name( name ), value( tl.mean() ), stddev( tl.mean_stddev() ), metric( m ), samples( nullptr ) {}
 };
 
 struct player_scaling_t
@@ -4487,6 +4655,7 @@ struct player_t : public actor_t
   virtual void demise();
   virtual timespan_t available() const { return timespan_t::from_seconds( 0.1 ); }
   virtual action_t* select_action( const action_priority_list_t& );
+  action_t* select_compiled_action( action_priority_list_t& );
   virtual action_t* execute_action();
 
   virtual void   regen( timespan_t periodicity = timespan_t::from_seconds( 0.25 ) );
@@ -4876,6 +5045,21 @@ public:
   // action_priority_list_t::internal_id for lists.
   unsigned action_list_id_;
 
+  // monitor_cpu profile entry for action priority list evaluation
+  cpu_profile_t* apl_cpu_profile;
+
+  // Memoized expression leaf values (memoize_expressions=1), shared by all
+  // actions of the actor that use the same expression
+  struct expr_memo_t
+  {
+    uint64_t generation;
+    const player_t* target;
+    double value;
+  };
+  std::vector<expr_memo_t> expr_memo;
+  std::unordered_map<std::string, unsigned> expr_memo_slots;
+  unsigned expr_memo_slot( const std::string& key );
+
   // Figure out another actor, by name. Prioritizes pets > harmful targets >
   // other players. Used by "actor.<name>" expression currently.
   virtual player_t* actor_by_name_str( const std::string& ) const;
@@ -5428,6 +5612,15 @@ public:
   /// Used for actions that will do awful things to the sim when a "false positive" skill roll happens.
   bool ignore_false_positive;
 
+  /**
+   * @brief Whether ready() honors the cooldown gates of action_t::ready().
+   *
+   * When true (default), action selection skips the action without calling ready() while its
+   * cooldown, internal cooldown or line cooldown is down. Set to false for actions whose ready()
+   * can return true while cooling down.
+   */
+  bool cooldown_gated_ready;
+
   /// Skill is now done per ability, with the default being set to the player option.
   double action_skill;
 
@@ -5736,6 +5929,7 @@ public:
   expr_t* target_if_expr;
   expr_t* interrupt_if_expr;
   expr_t* early_chain_if_expr;
+  expression::program_t if_program, target_if_program;
   action_t* sync_action;
   std::string signature_str;
   target_specific_t<dot_t> target_specific_dot;
@@ -5750,6 +5944,9 @@ public:
   proc_t* starved_proc;
   uint_least64_t total_executions;
 
+  /// monitor_cpu profile entries for execute, impact and tick, looked up on first use
+  std::array<cpu_profile_t*, cpu_profile_t::ACTION_PHASE_MAX> cpu_profile_entries;
+
   /**
    * @brief Cooldown for specific APL line.
    *
@@ -5785,6 +5982,13 @@ public:
     target_cache_t() : is_valid( false ) {}
   } mutable target_cache;
 
+  /**
+   * Reusable target list snapshots for cycle_targets and target_if evaluation. Expressions
+   * evaluated while iterating may regenerate the target cache, so the loops iterate over a copy;
+   * keeping the buffers on the action makes the copy allocation-free once they have grown.
+   */
+  std::vector< player_t* > cycle_targets_snapshot, target_if_snapshot;
+
 private:
   std::vector<std::unique_ptr<option_t>> options;
   action_state_t* state_cache;
@@ -5856,6 +6060,12 @@ public:
 
   player_t* select_target_if_target();
 
+  void optimize_expressions();
+
+  double evaluate_expr( expr_t* expr, expression::program_t& program );
+
+  void compile_expressions();
+
   // =======================
   // Const virtual functions
   // =======================
@@ -6127,6 +6337,9 @@ public:
   virtual gain_t* energize_gain( const action_state_t* /* state */ ) const
   { return gain; }
 
+  /// monitor_cpu profile entry of the given phase, nullptr when not monitoring
+  cpu_profile_t* cpu_profile( cpu_profile_t::action_phase_e phase );
+
   // ==========================
   // mutating virtual functions
   // ==========================
@@ -6157,6 +6370,10 @@ public:
 
   virtual bool ready();
 
+  /// Non-virtual check of the cooldown gates at the top of action_t::ready()
+  bool cooldown_gates_down() const
+  { return ! cooldown -> is_ready() || internal_cooldown -> down() || line_cooldown.down(); }
+
   virtual void init();
 
   virtual bool init_finished();
@@ -7057,6 +7274,46 @@ struct action_priority_t
   { comment_ = c; return this; }
 };
 
+// Compiled action priority list (apl_compiler). A list and every list it calls are lowered once
+// into one flat instruction stream. call_action_list lines jump into the code of the called list
+// and come back through an explicit return stack, instead of recursing into select_action().
+struct apl_program_t
+{
+  enum opcode_e
+  {
+    OP_ACTION = 0, // Ready action is the result
+    OP_VARIABLE,   // Ready variable operation is executed, continue
+    OP_CALL,       // Ready call_action_list enters the called list at jump
+    OP_RETURN      // End of a list, back to the calling list
+  };
+
+  struct instruction_t
+  {
+    opcode_e op;
+    unsigned jump;
+    uint64_t mask; // Internal id mask of the called list
+    action_t* action;
+  };
+
+  std::vector<instruction_t> code;
+  std::vector<action_t*> actions;
+  const action_priority_list_t* source;
+
+  // Differential mode bookkeeping
+  unsigned mismatches;
+
+  apl_program_t() : source( nullptr ), mismatches( 0 )
+  { }
+
+  bool compile( const action_priority_list_t& root );
+  void clear()
+  { code.clear(); actions.clear(); source = nullptr; mismatches = 0; }
+  bool compiled( const action_priority_list_t& root ) const
+  { return source == &root; }
+
+  action_t* run( player_t& p ) const;
+};
+
 struct action_priority_list_t
 {
   using parent_t = std::tuple<const action_priority_list_t*, size_t>;
@@ -7076,6 +7333,7 @@ struct action_priority_list_t
   std::vector<action_t*> off_gcd_actions;
   std::vector<parent_t> parents;
   int random; // Used to determine how faceroll something actually is. :D
+  apl_program_t program;
   action_priority_list_t( std::string name, player_t* p, const std::string& list_comment = std::string() ) :
     internal_id( 0 ), internal_id_mask( 0 ), name_str( name ), action_list_comment_str( list_comment ), player( p ), used( false ),
     foreground_action_list( 0 ), off_gcd_actions( 0 ), random( 0 )
@@ -7,6 +7,10 @@
 #include <iostream>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
 #include <chrono>
 
 #if defined( SC_WINDOWS )
@@ -35,29 +39,137 @@ public:
   { return m.native_handle(); }
 };
 
-class sc_thread_t::native_t
+namespace {
+
+// Process-wide pool of worker threads. Idle workers wait for submitted tasks; if a task is
+// submitted while no worker is idle, a new worker is spawned.
+class thread_pool_t : private noncopyable
 {
 private:
-  std::unique_ptr<std::thread> t;
+  std::mutex m;
+  std::condition_variable cv;
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()>> tasks;
+  size_t idle;
+  bool shutdown;
+
+  void worker()
+  {
+    while ( true )
+    {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock( m );
+        ++idle;
+        cv.wait( lock, [ this ] { return shutdown || ! tasks.empty(); } );
+        --idle;
+
+        if ( tasks.empty() )
+        {
+          return;
+        }
+
+        task = std::move( tasks.front() );
+        tasks.pop_front();
+      }
+
+      task();
+    }
+  }
+
+  // Must be called with the pool mutex held
+  void spawn()
+  { workers.emplace_back( &thread_pool_t::worker, this ); }
+
+public:
+  thread_pool_t() : idle( 0 ), shutdown( false )
+  { }
+
+  ~thread_pool_t()
+  {
+    {
+      std::lock_guard<std::mutex> lock( m );
+      shutdown = true;
+    }
+    cv.notify_all();
+
+    for ( auto& w : workers )
+    {
+      w.join();
+    }
+  }
+
+  void reserve( size_t n )
+  {
+    std::lock_guard<std::mutex> lock( m );
+    while ( workers.size() < n )
+    {
+      spawn();
+    }
+  }
+
+  void submit( std::function<void()> task )
+  {
+    {
+      std::lock_guard<std::mutex> lock( m );
+      tasks.push_back( std::move( task ) );
+      if ( tasks.size() > idle )
+      {
+        spawn();
+      }
+    }
+    cv.notify_one();
+  }
+};
 
-  static void execute( sc_thread_t* t )
+std::mutex pool_mutex;
+std::unique_ptr<thread_pool_t> pool_instance;
+
+thread_pool_t& pool()
+{
+  std::lock_guard<std::mutex> lock( pool_mutex );
+  if ( ! pool_instance )
   {
-    t -> run();
+    pool_instance = std::unique_ptr<thread_pool_t>( new thread_pool_t() );
   }
+
+  return *pool_instance;
+}
+
+} // anonymous namespace
+
+class sc_thread_t::native_t
+{
+private:
+  std::mutex m;
+  std::condition_variable cv;
+  bool running;
+
 public:
   native_t() :
-  t()
+  running( false )
   { }
 
-  void launch( sc_thread_t* thr)
+  void launch( sc_thread_t* thr )
   {
-    t = std::unique_ptr<std::thread>( new std::thread( &sc_thread_t::native_t::execute, thr ) );
+    {
+      std::lock_guard<std::mutex> lock( m );
+      running = true;
+    }
+
+    pool().submit( [ this, thr ]() {
+      thr -> run();
+
+      // Notify under the lock, the joining thread may destroy this object as soon as it returns
+      std::lock_guard<std::mutex> lock( m );
+      running = false;
+      cv.notify_all();
+    } );
   }
 
   void join() {
-    if ( t && t -> joinable() ) {
-      t -> join();
-    }
+    std::unique_lock<std::mutex> lock( m );
+    cv.wait( lock, [ this ] { return ! running; } );
   }
 
   static void sleep_seconds( double t )
@@ -203,4 +315,24 @@ void set_main_thread_priority()
 #else
 #endif
 }
+
+/**
+ * @brief Pre-spawn workers for the process-wide thread pool.
+ *
+ * The pool is also created on demand by sc_thread_t::launch(), and grows if more threads are
+ * launched concurrently than there are idle workers.
+ */
+void init_pool( unsigned n_workers )
+{
+  pool().reserve( n_workers );
+}
+
+/**
+ * @brief Join and destroy all pool workers. No launched threads may be running.
+ */
+void shutdown_pool()
+{
+  std::lock_guard<std::mutex> lock( pool_mutex );
+  pool_instance.reset();
+}
 }
\ No newline at end of file
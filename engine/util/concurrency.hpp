@@ -14,6 +14,7 @@
 #include "config.hpp"
 #include "generic.hpp"
 #include <memory>
+#include <functional>
 
 
 class mutex_t : private noncopyable
@@ -46,6 +47,19 @@ public:
   static unsigned cpu_thread_count();
 };
 
+// Runs a function object on the process-wide thread pool, for concurrent work that is not itself
+// a simulator (e.g. profileset and scale factor job workers)
+class sc_task_thread_t : public sc_thread_t
+{
+private:
+  std::function<void()> task;
+  void run() override
+  { task(); }
+public:
+  sc_task_thread_t( std::function<void()> t ) : task( std::move( t ) )
+  { }
+};
+
 class auto_lock_t
 {
 private:
@@ -74,4 +88,9 @@ namespace thread
 {
   // Windows (10) needs to promote main thread to higher priority
   void set_main_thread_priority();
+
+  // Process-wide worker pool that runs launched sc_thread_t objects. Workers persist across
+  // simulator phases and the pool grows on demand, so launch() never blocks waiting for a worker.
+  void init_pool( unsigned n_workers );
+  void shutdown_pool();
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 // ==========================================================================
 //#include "dbc/dbc.hpp"
 
+#include <algorithm>
 #include <ctime>
 #include <stdint.h>
 #include <string>
@@ -63,40 +64,40 @@ double convert_to_double_0_1( uint64_t ui64 )
  * maintenance cost.
  * Unfortunately, it is slower than the dsfmt implementation.
  */
-struct rng_mt_cxx11_t : public rng_t
+struct rng_mt_cxx11_t
 {
   std::mt19937 engine; // Mersenne twister MT19937
   std::uniform_real_distribution<double> dist;
 
   rng_mt_cxx11_t() : dist(0,1) {}
 
-  virtual const char* name() const override { return "mt_cxx11"; }
+  const char* name() const { return "mt_cxx11"; }
 
-  virtual void seed( uint64_t start ) override
+  void seed( uint64_t start )
   { 
     engine.seed( (unsigned) start ); 
   }
 
-  virtual double real() override
+  double real()
   { 
     return dist( engine );
   }
 };
 
-struct rng_mt_cxx11_64_t : public rng_t
+struct rng_mt_cxx11_64_t
 {
   std::mt19937_64 engine; // Mersenne twister MT19937
 
   rng_mt_cxx11_64_t() = default;
 
-  virtual const char* name() const override { return "mt_cxx11_64"; }
+  const char* name() const { return "mt_cxx11_64"; }
 
-  virtual void seed( uint64_t start ) override
+  void seed( uint64_t start )
   {
     engine.seed( start );
   }
 
-  virtual double real() override
+  double real()
   {
     return convert_to_double_0_1(engine());
   }
@@ -108,7 +109,7 @@ struct rng_mt_cxx11_64_t : public rng_t
  *
  * All credit goes to https://code.google.com/p/smhasher
  */
-struct rng_murmurhash_t : public rng_t
+struct rng_murmurhash_t
 {
   uint64_t x; /* The state must be seeded with a nonzero value. */
 
@@ -121,15 +122,15 @@ struct rng_murmurhash_t : public rng_t
     return x ^= x >> 33;
   }
 
-  virtual const char* name() const override { return "murmurhash3"; }
+  const char* name() const { return "murmurhash3"; }
 
-  virtual void seed( uint64_t start ) override
+  void seed( uint64_t start )
   { 
     assert( start != 0 );
     x = start;
   }
 
-  virtual double real() override
+  double real()
   { 
     return convert_to_double_0_1( next() );
   }
@@ -142,7 +143,7 @@ struct rng_murmurhash_t : public rng_t
  * All credit goes to Sebastiano Vigna (vigna@acm.org) @2014
  * http://xorshift.di.unimi.it/
  */
-struct rng_xorshift64_t : public rng_t
+struct rng_xorshift64_t
 {
   uint64_t x; /* The state must be seeded with a nonzero value. */
 
@@ -154,15 +155,15 @@ struct rng_xorshift64_t : public rng_t
     return x * 2685821657736338717LL;
   }
 
-  virtual const char* name() const override { return "xorshift64"; }
+  const char* name() const { return "xorshift64"; }
 
-  virtual void seed( uint64_t start ) override
+  void seed( uint64_t start )
   { 
     assert( start != 0 );
     x = start;
   }
 
-  virtual double real() override
+  double real()
   { 
     return convert_to_double_0_1( next() );
   }
@@ -175,7 +176,7 @@ struct rng_xorshift64_t : public rng_t
  * All credit goes to Sebastiano Vigna (vigna@acm.org) @2014
  * http://xorshift.di.unimi.it/
  */
-struct rng_xorshift128_t : public rng_t
+struct rng_xorshift128_t
 {
   uint64_t s[ 2 ];
 
@@ -188,9 +189,9 @@ struct rng_xorshift128_t : public rng_t
     return ( s[ 1 ] = ( s1 ^ s0 ^ ( s1 >> 17 ) ^ ( s0 >> 26 ) ) ) + s0; // b, c
   }
 
-  virtual const char* name() const override { return "xorshift128"; }
+  const char* name() const { return "xorshift128"; }
 
-  virtual void seed( uint64_t start ) override
+  void seed( uint64_t start )
   { 
     rng_murmurhash_t mmh;
     mmh.seed( start );
@@ -199,7 +200,7 @@ struct rng_xorshift128_t : public rng_t
     s[ 1 ] = mmh.next();
   }
 
-  virtual double real() override
+  double real()
   { 
     return convert_to_double_0_1( next() );
   }
@@ -212,7 +213,7 @@ struct rng_xorshift128_t : public rng_t
  * All credit goes to Sebastiano Vigna (vigna@acm.org) @2014
  * http://xorshift.di.unimi.it/
  */
-struct rng_xorshift1024_t : public rng_t
+struct rng_xorshift1024_t
 {
   uint64_t s[ 16 ]; 
   int p;
@@ -227,9 +228,9 @@ struct rng_xorshift1024_t : public rng_t
     return ( s[ p ] = s0 ^ s1 ) * 1181783497276652981LL; 
   }
 
-  virtual const char* name() const override { return "xorshift1024"; }
+  const char* name() const { return "xorshift1024"; }
 
-  virtual void seed( uint64_t start ) override
+  void seed( uint64_t start )
   { 
     rng_xorshift64_t xs64;
     xs64.seed( start );
@@ -237,7 +238,7 @@ struct rng_xorshift1024_t : public rng_t
     p = 0;
   }
 
-  virtual double real() override
+  double real()
   { 
     return convert_to_double_0_1( next() );
   }
@@ -257,7 +258,7 @@ struct rng_xorshift1024_t : public rng_t
  *
  * The new BSD License is applied to this software.
  */
-struct rng_sfmt_t : public rng_t
+struct rng_sfmt_t
 {
   /** 128-bit data structure */
   union w128_t
@@ -487,15 +488,9 @@ struct rng_sfmt_t : public rng_t
     // Validate proper alignment for SSE2 types.
     assert( ( uintptr_t ) dsfmt_global_data.status % 16 == 0 );
   }
-  // 32-bit libraries typically align malloc chunks to sizeof(double) == 8.
-  // This object needs to be aligned to sizeof(__m128d) == 16.
-  static void* operator new( size_t size )
-  { return _mm_malloc( size, sizeof( __m128d ) ); }
-  static void operator delete( void* p )
-  { return _mm_free( p ); }
 #endif
 
-  virtual const char* name() const override {
+  const char* name() const {
 #ifdef RNG_USE_SSE2
     return "sse2-sfmt";
 #else
@@ -503,25 +498,44 @@ struct rng_sfmt_t : public rng_t
 #endif
   }
   
-  virtual void seed( uint64_t start ) override
+  void seed( uint64_t start )
   { 
     dsfmt_chk_init_gen_rand( &dsfmt_global_data, (uint32_t) start ); 
   }
 
-  virtual double real() override
+  double real()
   { 
     return dsfmt_genrand_close_open( &dsfmt_global_data ) - 1.0; 
   }
 
   /**
-   * Special implementation because dsfmt only allows 32bit seed
+   * Bulk generation: copy the state array out directly, regenerating all of it with
+   * dsfmt_gen_rand_all() whenever it runs empty.
    */
-  virtual uint64_t reseed() override
+  void fill( double* out, size_t n )
   {
-    uint64_t s = dsfmt_genrand_uint32( &dsfmt_global_data );
-    seed( s );
-    reset();
-    return s;
+    const double* psfmt64 = &dsfmt_global_data.status[0].d[0];
+    while ( n > 0 )
+    {
+      if ( dsfmt_global_data.idx >= DSFMT_N64 )
+      {
+        dsfmt_gen_rand_all( &dsfmt_global_data );
+        dsfmt_global_data.idx = 0;
+      }
+      size_t count = std::min( n, static_cast<size_t>( DSFMT_N64 - dsfmt_global_data.idx ) );
+      const double* src = psfmt64 + dsfmt_global_data.idx;
+      for ( size_t i = 0; i < count; ++i )
+        out[ i ] = src[ i ] - 1.0;
+      dsfmt_global_data.idx += static_cast<int>( count );
+      out += count;
+      n -= count;
+    }
+  }
+
+  /// dsfmt only allows 32bit seed
+  uint64_t reseed_value()
+  {
+    return dsfmt_genrand_uint32( &dsfmt_global_data );
   }
 };
 
@@ -536,7 +550,7 @@ struct rng_sfmt_t : public rng_t
  * Hiroshima University and The University of Tokyo.
  * All rights reserved.
  */
-struct rng_tinymt_t : public rng_t
+struct rng_tinymt_t
 {
   static const uint64_t TINYMT64_SH0  = 12;
   static const uint64_t TINYMT64_SH1  = 11;
@@ -601,9 +615,9 @@ struct rng_tinymt_t : public rng_t
     period_certification();
   }
 
-  virtual const char* name() const override { return "tinymt"; }
+  const char* name() const { return "tinymt"; }
 
-  virtual void seed( uint64_t start ) override
+  void seed( uint64_t start )
   {
     // mat1, mat2, and tmat are inputs to the engine
     // I am uncertain how to set them so we'll just grind the seed through MurmurHash.
@@ -616,13 +630,71 @@ struct rng_tinymt_t : public rng_t
     init( start );
   }
 
-  virtual double real() override
+  double real()
   {
     next_state();
     return temper_conv_open() - 1.0;
   }
 };
 
+
+/// Generic block generation, one inlined engine call per number.
+template <typename Engine>
+void fill_block( Engine& engine, double* out, size_t n )
+{
+  for ( size_t i = 0; i < n; ++i )
+    out[ i ] = engine.real();
+}
+
+void fill_block( rng_sfmt_t& engine, double* out, size_t n )
+{
+  engine.fill( out, n );
+}
+
+/**
+ * @brief Block-buffered rng_t front end for a concrete engine
+ *
+ * The engine is a plain member, so its seed() and real() are non-virtual and get
+ * inlined into fill(). rng_t only pays one virtual call per BLOCK_SIZE numbers.
+ */
+template <typename Engine>
+struct rng_engine_t : public rng_t
+{
+  Engine engine;
+
+  virtual const char* name() const override
+  { return engine.name(); }
+
+  virtual uint64_t reseed() override
+  { return rng_t::reseed(); }
+
+#if defined(RNG_USE_SSE2)
+  // 32-bit libraries typically align malloc chunks to sizeof(double) == 8.
+  // The SFMT engine needs to be aligned to sizeof(__m128d) == 16.
+  static void* operator new( size_t size )
+  { return _mm_malloc( size, sizeof( __m128d ) ); }
+  static void operator delete( void* p )
+  { return _mm_free( p ); }
+#endif
+
+protected:
+  virtual void seed_engine( uint64_t start ) override
+  { engine.seed( start ); }
+
+  virtual void fill( double* out, size_t n ) override
+  { fill_block( engine, out, n ); }
+};
+
+/// Special implementation because dsfmt only allows 32bit seed
+template <>
+uint64_t rng_engine_t<rng_sfmt_t>::reseed()
+{
+  uint64_t s = engine.reseed_value();
+  seed( s );
+  reset();
+  return s;
+}
+
 } // unnamed
 
 // ==========================================================================
@@ -644,52 +716,158 @@ double rng_t::range( double min, double max )
   return min + real() * ( max - min );
 }
 
+namespace {
+
 /**
- * @brief Gaussian Distribution
- *
- * This code adapted from ftp://ftp.taygeta.com/pub/c/boxmuller.c
- * Implements the Polar form of the Box-Muller Transformation
+ * @brief Ziggurat layer tables
  *
- * (c) Copyright 1994, Everett F. Carter Jr.
- *     Permission is granted by the author to use
- *     this software for any application provided this
- *     copyright notice is preserved.
+ * Layout after J. A. Doornik, "An Improved Ziggurat Method to Generate Normal
+ * Random Samples" (2005): x[0] is the width of the base strip including the
+ * tail ( V / f(R) ), x[1] = R, x[LAYERS] = 0, and ratio[i] = x[i+1] / x[i] is
+ * the fraction of layer i that lies entirely below the density.
  */
-double rng_t::gauss( double mean, double stddev, bool truncate_low_end )
+template <unsigned LAYERS>
+struct ziggurat_table_t
 {
+  double x[ LAYERS + 1 ];
+  double ratio[ LAYERS ];
+  double f[ LAYERS + 1 ];
+};
 
-  
-  double z;
+/// Standard normal, f(x) = exp( -x^2 / 2 ), 128 layers.
+struct ziggurat_normal_t : public ziggurat_table_t<128>
+{
+  static const unsigned LAYERS = 128;
+  static constexpr double R = 3.442619855899;
+  static constexpr double V = 9.91256303526217e-3;
+
+  ziggurat_normal_t()
+  {
+    double fx = std::exp( -0.5 * R * R );
+    x[ 0 ] = V / fx;
+    x[ 1 ] = R;
+    x[ LAYERS ] = 0;
+    for ( unsigned i = 2; i < LAYERS; ++i )
+    {
+      x[ i ] = std::sqrt( -2.0 * std::log( V / x[ i - 1 ] + fx ) );
+      fx = std::exp( -0.5 * x[ i ] * x[ i ] );
+    }
+    for ( unsigned i = 0; i <= LAYERS; ++i )
+    {
+      if ( i < LAYERS )
+        ratio[ i ] = x[ i + 1 ] / x[ i ];
+      f[ i ] = std::exp( -0.5 * x[ i ] * x[ i ] );
+    }
+  }
+};
 
-  if ( stddev != 0 )
+/// Standard exponential, f(x) = exp( -x ), 256 layers.
+struct ziggurat_exponential_t : public ziggurat_table_t<256>
+{
+  static const unsigned LAYERS = 256;
+  static constexpr double R = 7.69711747013104972;
+  static constexpr double V = 3.949659822581572e-3;
+
+  ziggurat_exponential_t()
   {
-    if ( gauss_pair_use )
+    double fx = std::exp( -R );
+    x[ 0 ] = V / fx;
+    x[ 1 ] = R;
+    x[ LAYERS ] = 0;
+    for ( unsigned i = 2; i < LAYERS; ++i )
+    {
+      x[ i ] = -std::log( V / x[ i - 1 ] + fx );
+      fx = std::exp( -x[ i ] );
+    }
+    for ( unsigned i = 0; i <= LAYERS; ++i )
     {
-      z = gauss_pair_value;
-      gauss_pair_use = false;
+      if ( i < LAYERS )
+        ratio[ i ] = x[ i + 1 ] / x[ i ];
+      f[ i ] = std::exp( -x[ i ] );
     }
-    else
+  }
+};
+
+const ziggurat_normal_t zig_normal;
+const ziggurat_exponential_t zig_exponential;
+
+} // unnamed
+
+/**
+ * @brief Standard normal sample, ziggurat method
+ *
+ * A single uniform picks both the layer ( top 7 bits ) and the signed position
+ * inside it ( remaining bits ). About 99% of samples are accepted by the
+ * rectangle test alone and cost no transcendental.
+ */
+double rng_t::stdnormal()
+{
+  const ziggurat_normal_t& z = zig_normal;
+
+  for ( ;; )
+  {
+    double r = real() * z.LAYERS;
+    unsigned i = static_cast<unsigned>( r );
+    double u = 2.0 * ( r - i ) - 1.0;
+
+    if ( std::fabs( u ) < z.ratio[ i ] )
+      return u * z.x[ i ];
+
+    if ( i == 0 )
     {
-      double x1, x2, w, y1, y2;
+      // Marsaglia's tail method beyond R
+      double x, y;
       do
       {
-  x1 = 2.0 * real() - 1.0;
-  x2 = 2.0 * real() - 1.0;
-  w = x1 * x1 + x2 * x2;
+        x = std::log( 1.0 - real() ) / z.R;
+        y = std::log( 1.0 - real() );
       }
-      while ( w >= 1.0 || w == 0.0 );
-
-      w = sqrt( ( -2.0 * log( w ) ) / w );
-      y1 = x1 * w;
-      y2 = x2 * w;
-      
-      z = y1;
-      gauss_pair_value = y2;
-      gauss_pair_use = true;
+      while ( -2.0 * y < x * x );
+      return u < 0 ? x - z.R : z.R - x;
     }
+
+    // Wedge between the rectangle and the density
+    double x = u * z.x[ i ];
+    double f0 = z.f[ i ];
+    double f1 = z.f[ i + 1 ];
+    if ( f1 + real() * ( f0 - f1 ) < std::exp( -0.5 * x * x ) )
+      return x;
   }
-  else
-    z = 0.0;
+}
+
+/**
+ * @brief Standard exponential sample, ziggurat method
+ *
+ * Same layout as stdnormal(), on the one-sided density exp( -x ).
+ */
+double rng_t::stdexponential()
+{
+  const ziggurat_exponential_t& z = zig_exponential;
+
+  for ( ;; )
+  {
+    double r = real() * z.LAYERS;
+    unsigned i = static_cast<unsigned>( r );
+    double x = ( r - i ) * z.x[ i ];
+
+    if ( x < z.x[ i + 1 ] )
+      return x;
+
+    // The exponential tail beyond R is R plus a standard exponential.
+    if ( i == 0 )
+      return z.R - std::log( 1.0 - real() );
+
+    double f0 = z.f[ i ];
+    double f1 = z.f[ i + 1 ];
+    if ( f1 + real() * ( f0 - f1 ) < std::exp( -x ) )
+      return x;
+  }
+}
+
+/// Gaussian Distribution
+double rng_t::gauss( double mean, double stddev, bool truncate_low_end )
+{
+  double z = stddev != 0 ? stdnormal() : 0.0;
 
   double result = mean + z * stddev;
 
@@ -703,9 +881,7 @@ double rng_t::gauss( double mean, double stddev, bool truncate_low_end )
 /// Exponential Distribution
 double rng_t::exponential( double nu )
 {
-  double x;
-  do { x = real(); } while ( x >= 1.0 ); // avoid ln(0)
-  return - std::log( 1 - x ) * nu;
+  return stdexponential() * nu;
 }
 
 /// Exponentially Modified Gaussian Distribution
@@ -751,12 +927,11 @@ uint64_t rng_t::reseed()
 /// reset any state
 void rng_t::reset()
 {
-  gauss_pair_value = 0;
-  gauss_pair_use = false;
+  // Distributions are stateless; numbers buffered from the current seed stay valid.
 }
 
 rng_t::rng_t() :
-    gauss_pair_value( 0.0 ), gauss_pair_use( false )
+    buffer_pos( BLOCK_SIZE )
 {
 }
 
@@ -778,6 +953,20 @@ rng_t::type_e parse_type( const std::string& n )
   return rng_t::DEFAULT;
 }
 
+/**
+ * Seed of an independent random stream, derived from a base seed and the stream number with the
+ * SplitMix64 finalizer. Never returns 0, which some engines do not accept as seed.
+ */
+uint64_t stream_seed( uint64_t seed, uint64_t stream )
+{
+  uint64_t z = seed + ( stream + 1 ) * 0x9E3779B97F4A7C15ULL;
+  z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+  z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+
+  return z != 0 ? z : 1;
+}
+
 /**
  * Factory method to create a rng object with given rng-engine type
  */
@@ -786,25 +975,25 @@ std::unique_ptr<rng_t> create( rng_t::type_e t )
   switch( t )
   {
   case rng_t::MURMURHASH:
-    return std::unique_ptr<rng_t>(new rng_murmurhash_t());
+    return std::unique_ptr<rng_t>(new rng_engine_t<rng_murmurhash_t>());
 
   case rng_t::STD:
-    return std::unique_ptr<rng_t>(new rng_mt_cxx11_t());
+    return std::unique_ptr<rng_t>(new rng_engine_t<rng_mt_cxx11_t>());
 
   case rng_t::SFMT:
-    return std::unique_ptr<rng_t>(new rng_sfmt_t());
+    return std::unique_ptr<rng_t>(new rng_engine_t<rng_sfmt_t>());
 
   case rng_t::TINYMT:
-    return std::unique_ptr<rng_t>(new rng_tinymt_t());
+    return std::unique_ptr<rng_t>(new rng_engine_t<rng_tinymt_t>());
 
   case rng_t::XORSHIFT64:
-    return std::unique_ptr<rng_t>(new rng_xorshift64_t());
+    return std::unique_ptr<rng_t>(new rng_engine_t<rng_xorshift64_t>());
 
   case rng_t::XORSHIFT128:
-    return std::unique_ptr<rng_t>(new rng_xorshift128_t());
+    return std::unique_ptr<rng_t>(new rng_engine_t<rng_xorshift128_t>());
 
   case rng_t::XORSHIFT1024:
-    return std::unique_ptr<rng_t>(new rng_xorshift1024_t());
+    return std::unique_ptr<rng_t>(new rng_engine_t<rng_xorshift1024_t>());
 
   case rng_t::DEFAULT:
   default:
@@ -995,6 +1184,7 @@ double stdnormal_inv( double p )
 
 #include <iostream>
 #include <iomanip>
+#include <vector>
 
 namespace rng {
 static int64_t milliseconds()
@@ -1039,6 +1229,70 @@ static void test_seed( rng_t* rng, uint64_t n )
                ", numbers/sec = " << static_cast<uint64_t>( n * 1000.0 / elapsed_cpu ) << "\n\n";
 }
 
+// Per-call virtual engine, the way rng_t::real() used to dispatch.
+struct rng_unbuffered_t
+{
+  virtual ~rng_unbuffered_t() {}
+  virtual double real() = 0;
+};
+
+template <typename Engine>
+struct rng_unbuffered_engine_t : public rng_unbuffered_t
+{
+  Engine engine;
+  virtual double real() override { return engine.real(); }
+};
+
+// Count successful 30% rolls, the typical proc check pattern.
+static uint64_t roll_unbuffered( rng_unbuffered_t* rng, uint64_t n )
+{
+  uint64_t count = 0;
+  for ( uint64_t i = 0; i < n; ++i )
+    count += rng -> real() < 0.3;
+  return count;
+}
+
+static uint64_t roll_buffered( rng_t* rng, uint64_t n )
+{
+  uint64_t count = 0;
+  for ( uint64_t i = 0; i < n; ++i )
+    count += rng -> real() < 0.3;
+  return count;
+}
+
+// Microbenchmark of the block-buffered front end against a virtual call per number.
+template <typename Engine>
+static void test_block( uint64_t seed, uint64_t n )
+{
+  rng_unbuffered_engine_t<Engine>* u = new rng_unbuffered_engine_t<Engine>();
+  u -> engine.seed( seed );
+  rng_t* b = new rng_engine_t<Engine>();
+  b -> seed( seed );
+
+  // Launder through volatile so the compiler cannot devirtualize the calls.
+  rng_unbuffered_t* volatile unbuffered_v = u;
+  rng_t* volatile buffered_v = b;
+  rng_unbuffered_t* unbuffered = unbuffered_v;
+  rng_t* buffered = buffered_v;
+
+  int64_t start_time = milliseconds();
+  uint64_t count_u = roll_unbuffered( unbuffered, n );
+  int64_t elapsed_u = std::max( int64_t( 1 ), milliseconds() - start_time );
+
+  start_time = milliseconds();
+  uint64_t count_b = roll_buffered( buffered, n );
+  int64_t elapsed_b = std::max( int64_t( 1 ), milliseconds() - start_time );
+
+  std::cout << n << " calls to " << buffered -> name() << "::real()"
+            << ": unbuffered calls/sec = " << static_cast<uint64_t>( n * 1000.0 / elapsed_u )
+            << ", buffered calls/sec = " << static_cast<uint64_t>( n * 1000.0 / elapsed_b )
+            << ", speedup = " << std::setprecision( 3 ) << static_cast<double>( elapsed_u ) / elapsed_b
+            << ", identical stream = " << ( count_u == count_b ? "yes" : "no" ) << "\n\n";
+
+  delete u;
+  delete b;
+}
+
 // Monte-Carlo PI calculation.
 static void monte_carlo( rng_t* rng, uint64_t n )
 {
@@ -1061,18 +1315,120 @@ static void monte_carlo( rng_t* rng, uint64_t n )
                ", numbers/sec = " << static_cast<uint64_t>( n * 1000.0 / elapsed_cpu ) << "\n\n";
 }
 
+// Reference samplers the ziggurat paths replaced, for the throughput comparison.
+static double gauss_polar( rng_t* rng )
+{
+  static double pair_value;
+  static bool pair_use = false;
+
+  if ( pair_use )
+  {
+    pair_use = false;
+    return pair_value;
+  }
+
+  double x1, x2, w;
+  do
+  {
+    x1 = 2.0 * rng -> real() - 1.0;
+    x2 = 2.0 * rng -> real() - 1.0;
+    w = x1 * x1 + x2 * x2;
+  }
+  while ( w >= 1.0 || w == 0.0 );
+
+  w = sqrt( ( -2.0 * log( w ) ) / w );
+  pair_value = x2 * w;
+  pair_use = true;
+  return x1 * w;
+}
+
+static double exponential_inversion( rng_t* rng )
+{
+  return - std::log( 1 - rng -> real() );
+}
+
+static double exponential_cdf( double x )
+{
+  return x <= 0 ? 0.0 : 1.0 - std::exp( -x );
+}
+
+/**
+ * Statistical check of a sampler against its cdf: chi-square over equiprobable bins
+ * and the first four moments. Returns false if any of them is out of tolerance.
+ */
+template <typename Sampler>
+static bool test_distribution( const char* name, Sampler sample, double ( *cdf )( double ),
+                               double mean, double variance, double skewness, double kurtosis, uint64_t n )
+{
+  const unsigned bins = 100;
+  std::vector<uint64_t> count( bins );
+  double m1 = 0, m2 = 0, m3 = 0, m4 = 0;
+
+  for ( uint64_t i = 0; i < n; ++i )
+  {
+    double x = sample();
+    unsigned bin = static_cast<unsigned>( cdf( x ) * bins );
+    count[ std::min( bin, bins - 1 ) ]++;
+    double d = x - mean;
+    m1 += d;
+    m2 += d * d;
+    m3 += d * d * d;
+    m4 += d * d * d * d;
+  }
+
+  double expected = static_cast<double>( n ) / bins;
+  double chi2 = 0;
+  for ( unsigned i = 0; i < bins; ++i )
+    chi2 += ( count[ i ] - expected ) * ( count[ i ] - expected ) / expected;
+
+  m1 /= n; m2 /= n; m3 /= n; m4 /= n;
+  double var = m2 - m1 * m1;
+  double skew = m3 / std::pow( variance, 1.5 );
+  double kurt = m4 / ( variance * variance ) - 3.0;
+
+  // chi2 with 99 degrees of freedom: mean 99, stddev 14. Moment tolerances are
+  // several standard errors at n samples.
+  double se = 1.0 / std::sqrt( static_cast<double>( n ) );
+  bool ok = chi2 < 99 + 5 * 14 &&
+            std::fabs( m1 ) < 6 * se * std::sqrt( variance ) &&
+            std::fabs( var - variance ) < 10 * se * variance &&
+            std::fabs( skew - skewness ) < 20 * se * std::max( 1.0, skewness ) &&
+            std::fabs( kurt - kurtosis ) < 60 * se * std::max( 1.0, kurtosis );
+
+  std::cout << n << " samples of " << name << ": chi2(99) = " << std::setprecision( 5 ) << chi2
+            << ", mean = " << mean + m1 << ", variance = " << var
+            << ", skewness = " << skew << ", excess kurtosis = " << kurt
+            << ( ok ? " PASS" : " FAIL" ) << "\n\n";
+  return ok;
+}
+
+template <typename Sampler>
+static void test_throughput( const char* name, Sampler sample, uint64_t n )
+{
+  int64_t start_time = milliseconds();
+
+  double sum = 0;
+  for ( uint64_t i = 0; i < n; ++i )
+    sum += sample();
+  int64_t elapsed_cpu = std::max( int64_t( 1 ), milliseconds() - start_time );
+
+  std::cout << n << " calls to " << name << ": average = " << std::setprecision( 8 ) << sum / n
+            << ", time = " << elapsed_cpu << " ms"
+               ", numbers/sec = " << static_cast<uint64_t>( n * 1000.0 / elapsed_cpu ) << "\n\n";
+}
+
 } // namespace rng
 
 int main( int /*argc*/, char** /*argv*/ )
 {
   using namespace rng;
-  rng_t* rng_mt_cxx11   = new rng_mt_cxx11_t();
-  rng_t* rng_mt_cxx11_64   = new rng_mt_cxx11_64_t();
-  rng_t* rng_murmurhash   = new rng_murmurhash_t();
-  rng_t* rng_sfmt   = new rng_sfmt_t();
-  rng_t* rng_tinymt = new rng_tinymt_t();
-  rng_t* rng_xs128  = new rng_xorshift128_t();
-  rng_t* rng_xs1024 = new rng_xorshift1024_t();
+  rng_t* rng_mt_cxx11   = new rng_engine_t<rng_mt_cxx11_t>();
+  rng_t* rng_mt_cxx11_64   = new rng_engine_t<rng_mt_cxx11_64_t>();
+  rng_t* rng_murmurhash   = new rng_engine_t<rng_murmurhash_t>();
+  rng_t* rng_sfmt   = new rng_engine_t<rng_sfmt_t>();
+  rng_t* rng_tinymt = new rng_engine_t<rng_tinymt_t>();
+  rng_t* rng_xs128  = new rng_engine_t<rng_xorshift128_t>();
+  rng_t* rng_xs1024 = new rng_engine_t<rng_xorshift1024_t>();
 
   std::random_device rd;
   uint64_t seed  = uint64_t(rd()) | (uint64_t(rd()) << 32);
@@ -1097,6 +1453,12 @@ int main( int /*argc*/, char** /*argv*/ )
   test_one( rng_xs128,  n );
   test_one( rng_xs1024, n );
 
+  test_block<rng_mt_cxx11_64_t>( seed, n );
+  test_block<rng_sfmt_t>( seed, n );
+  test_block<rng_tinymt_t>( seed, n );
+  test_block<rng_xorshift128_t>( seed, n );
+  test_block<rng_xorshift1024_t>( seed, n );
+
   monte_carlo( rng_mt_cxx11,   n );
   monte_carlo( rng_murmurhash,   n );
   monte_carlo( rng_sfmt,   n );
@@ -1167,6 +1529,23 @@ int main( int /*argc*/, char** /*argv*/ )
               "time = " << elapsed_cpu << " ms\n\n";
   }
 
+  // ziggurat against the polar Box-Muller and inversion methods
+  {
+    test_distribution( "stdnormal (ziggurat)", [ rng ]() { return rng -> stdnormal(); },
+                       stdnormal_cdf, 0.0, 1.0, 0.0, 0.0, n );
+    test_distribution( "stdnormal (polar)", [ rng ]() { return gauss_polar( rng ); },
+                       stdnormal_cdf, 0.0, 1.0, 0.0, 0.0, n );
+    test_distribution( "stdexponential (ziggurat)", [ rng ]() { return rng -> stdexponential(); },
+                       exponential_cdf, 1.0, 1.0, 2.0, 6.0, n );
+    test_distribution( "stdexponential (inversion)", [ rng ]() { return exponential_inversion( rng ); },
+                       exponential_cdf, 1.0, 1.0, 2.0, 6.0, n );
+
+    test_throughput( "stdnormal (ziggurat)", [ rng ]() { return rng -> stdnormal(); }, n );
+    test_throughput( "stdnormal (polar)", [ rng ]() { return gauss_polar( rng ); }, n );
+    test_throughput( "stdexponential (ziggurat)", [ rng ]() { return rng -> stdexponential(); }, n );
+    test_throughput( "stdexponential (inversion)", [ rng ]() { return exponential_inversion( rng ); }, n );
+  }
+
   std::cout << "\nreal:\n";
   for ( unsigned i = 1; i <= 100; i++ )
   {
@@ -9,6 +9,7 @@
 /*! \defgroup SC_RNG Random Number Generator */
 
 #include "config.hpp"
+#include <cstddef>
 #include <memory>
 #include "sc_timespan.hpp"
 
@@ -21,22 +22,42 @@ namespace rng {
  *
  * Implements different rng-engines, selectable through a factory,
  * as well as different distribution outputs ( uniform, gauss, etc. )
+ *
+ * The engine is only called through fill(), once per BLOCK_SIZE numbers. real() is
+ * a non-virtual inline read from the buffer, so the per-number cost of roll(),
+ * range() and gauss() does not include a virtual call.
  */
 struct rng_t
 {
   /// rng engines
   enum type_e { DEFAULT, MURMURHASH, SFMT, STD, TINYMT, XORSHIFT64, XORSHIFT128, XORSHIFT1024 };
 
+  /// number of uniform doubles generated per engine call
+  static const size_t BLOCK_SIZE = 256;
+
   virtual ~rng_t() {}
   /// name of rng engine
   virtual const char* name() const = 0;
-  /// seed rng engine
-  virtual void seed( uint64_t start ) = 0;
-  /// uniform distribution in range [0,1]
-  virtual double real() = 0;
+  /// seed rng engine, discarding any buffered numbers
+  void seed( uint64_t start )
+  {
+    seed_engine( start );
+    buffer_pos = BLOCK_SIZE;
+  }
+  /// uniform distribution in range [0,1)
+  double real()
+  {
+    if ( buffer_pos == BLOCK_SIZE )
+      refill();
+    return buffer[ buffer_pos++ ];
+  }
   virtual uint64_t reseed();
   virtual void reset();
 
+  /// standard normal distribution, mean 0 and stddev 1
+  double stdnormal();
+  /// standard exponential distribution, mean 1
+  double stdexponential();
   bool roll( double chance );
   double range( double min, double max );
   double gauss( double mean, double stddev, bool truncate_low_end = false );
@@ -47,16 +68,26 @@ struct rng_t
   timespan_t exgauss( timespan_t mean, timespan_t stddev, timespan_t nu );
 protected:
   rng_t();
+  virtual void seed_engine( uint64_t start ) = 0;
+  /// generate n uniform doubles in range [0,1) into out
+  virtual void fill( double* out, size_t n ) = 0;
 private:
-  // Allow re-use of unused ( but necessary ) random number of a previous call to gauss()  
-  double gauss_pair_value; 
-  bool   gauss_pair_use;
+  void refill()
+  {
+    fill( buffer, BLOCK_SIZE );
+    buffer_pos = 0;
+  }
+
+  double buffer[ BLOCK_SIZE ];
+  size_t buffer_pos;
 
 };
 
 std::unique_ptr<rng_t> create( rng_t::type_e = rng_t::DEFAULT );
 rng_t::type_e parse_type( const std::string& name );
 
+uint64_t stream_seed( uint64_t seed, uint64_t stream );
+
 double stdnormal_cdf( double );
 double stdnormal_inv( double );
 
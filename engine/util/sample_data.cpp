@@ -11,11 +11,49 @@ int main( int /*argc*/, char** /*argv*/ )
   for( int i = 0; i < 1000; ++i )
     z.add( rand() );
 
-  z.analyze_all();
+  z.analyze();
 
   std::ostringstream s;
   z.data_str( s );
   std::cout << s.str();
+
+  // Streaming statistics must agree with the full analysis
+  const auto& rs = z.running_stats();
+  std::cout << "running: count: " << rs.count() << " mean: " << rs.mean()
+            << " variance: " << rs.variance() << " mean_std_dev: " << rs.mean_std_dev() << "\n";
+
+  // Sketch percentiles must be within the relative accuracy of the exact ones
+  extended_sample_data_t w( "bar", false );
+  w.use_sketch();
+  for ( auto v : z.data() )
+    w.add( v );
+
+  w.analyze();
+  for ( double q : { 0.0, 0.01, 0.25, 0.5, 0.75, 0.99, 1.0 } )
+  {
+    std::cout << "percentile " << q << ": exact: " << z.percentile( q )
+              << " sketch: " << w.percentile( q ) << "\n";
+  }
+  std::cout << "sketch: mean: " << w.mean() << " variance: " << w.variance << "\n";
+
+  // Compact storage keeps mean and variance at double precision, and samples
+  // within float precision of their offset from the first sample. Merging
+  // rebases the offsets of the other container.
+  extended_sample_data_t c1( "baz", false ), c2( "baz", false );
+  c1.use_compact();
+  c2.use_compact();
+  for ( size_t i = 0; i < z.data().size(); ++i )
+    ( i < z.data().size() / 2 ? c1 : c2 ).add( z.data()[ i ] );
+  c1.merge( c2 );
+  c1.analyze();
+
+  double max_error = 0;
+  for ( size_t i = 0; i < z.data().size(); ++i )
+    max_error = std::max( max_error, std::fabs( c1.sample( i ) - z.data()[ i ] ) );
+  std::cout << "compact: mean: " << c1.mean() << " ( exact " << z.mean() << " )"
+            << " variance: " << c1.variance << " ( exact " << z.variance << " )"
+            << " median: " << c1.percentile( 0.5 ) << " ( exact " << z.percentile( 0.5 ) << " )"
+            << " max sample error: " << max_error << "\n";
   return 0;
 }
 #endif // UNIT_TEST
@@ -6,6 +6,7 @@
 #ifndef SAMPLE_DATA_HPP
 #define SAMPLE_DATA_HPP
 
+#include <cmath>
 #include <limits>
 #include <numeric>
 #include <sstream>
@@ -20,7 +21,7 @@ namespace statistics
 /* Arithmetic Sum
  */
 template <typename Range>
-typename Range::value_type calculate_sum( Range r )
+typename Range::value_type calculate_sum( const Range& r )
 {
   using value_t = typename Range::value_type;
   return std::accumulate( std::begin( r ), std::end( r ), value_t{} );
@@ -29,7 +30,7 @@ typename Range::value_type calculate_sum( Range r )
 /* Arithmetic Mean
  */
 template <typename Range>
-typename Range::value_type calculate_mean( Range r )
+typename Range::value_type calculate_mean( const Range& r )
 {
   auto length = std::distance( std::begin( r ), std::end( r ) );
   auto tmp    = calculate_sum( r );
@@ -40,7 +41,7 @@ typename Range::value_type calculate_mean( Range r )
 /* Expected Value of the squared deviation from a given mean
  */
 template <typename Range>
-typename Range::value_type calculate_variance( Range r,
+typename Range::value_type calculate_variance( const Range& r,
                                                typename Range::value_type mean )
 {
   using value_t = typename Range::value_type;
@@ -59,7 +60,7 @@ typename Range::value_type calculate_variance( Range r,
 /* Expected Value of the squared deviation
  */
 template <typename Range>
-typename Range::value_type calculate_variance( Range r )
+typename Range::value_type calculate_variance( const Range& r )
 {
   return calculate_variance( r, calculate_mean( r ) );
 }
@@ -67,7 +68,7 @@ typename Range::value_type calculate_variance( Range r )
 /* Standard Deviation from a given mean
  */
 template <typename Range>
-typename Range::value_type calculate_stddev( Range r,
+typename Range::value_type calculate_stddev( const Range& r,
                                              typename Range::value_type mean )
 {
   return std::sqrt( calculate_variance( r, mean ) );
@@ -76,7 +77,7 @@ typename Range::value_type calculate_stddev( Range r,
 /* Standard Deviation
  */
 template <typename Range>
-typename Range::value_type calculate_stddev( Range r )
+typename Range::value_type calculate_stddev( const Range& r )
 {
   return std::sqrt( calculate_variance( r, calculate_mean( r ) ) );
 }
@@ -86,7 +87,7 @@ typename Range::value_type calculate_stddev( Range r )
  */
 template <typename Range>
 typename Range::value_type calculate_mean_stddev(
-    Range r, typename Range::value_type mean )
+    const Range& r, typename Range::value_type mean )
 {
   auto tmp    = calculate_variance( r, mean );
   auto length = std::distance( std::begin( r ), std::begin( r ) );
@@ -99,13 +100,13 @@ typename Range::value_type calculate_mean_stddev(
  * Limit Theorem
  */
 template <typename Range>
-typename Range::value_type calculate_mean_stddev( Range r )
+typename Range::value_type calculate_mean_stddev( const Range& r )
 {
   return calculate_mean_stddev( r, calculate_mean( r ) );
 }
 
 template <typename Range>
-std::vector<size_t> create_histogram( Range r, size_t num_buckets,
+std::vector<size_t> create_histogram( const Range& r, size_t num_buckets,
                                       typename Range::value_type min,
                                       typename Range::value_type max )
 {
@@ -137,7 +138,7 @@ std::vector<size_t> create_histogram( Range r, size_t num_buckets,
 }
 
 template <typename Range>
-std::vector<size_t> create_histogram( Range r, size_t num_buckets )
+std::vector<size_t> create_histogram( const Range& r, size_t num_buckets )
 {
   if ( std::begin( r ) == std::end( r ) )
     return std::vector<size_t>();
@@ -331,9 +332,246 @@ public:
   }
 };
 
+/* Streaming mean and variance accumulator ( Welford's algorithm ). Partial
+ * accumulators are combined with the pairwise update of Chan et al., so the
+ * statistics are available in O(1) at any time without a pass over the samples.
+ */
+class running_stats_t
+{
+public:
+  using value_t = double;
+
+private:
+  size_t _count = 0;
+  value_t _mean = 0.0;
+  value_t _m2   = 0.0;  // Sum of squared deviations from the mean
+
+public:
+  void add( value_t x )
+  {
+    ++_count;
+    value_t delta = x - _mean;
+    _mean += delta / _count;
+    _m2 += delta * ( x - _mean );
+  }
+
+  void merge( const running_stats_t& other )
+  {
+    if ( other._count == 0 )
+      return;
+
+    if ( _count == 0 )
+    {
+      *this = other;
+      return;
+    }
+
+    size_t count  = _count + other._count;
+    value_t delta = other._mean - _mean;
+    _mean += delta * other._count / count;
+    _m2 += other._m2 + delta * delta * _count * other._count / count;
+    _count = count;
+  }
+
+  void clear()
+  {
+    _count = 0;
+    _mean  = 0.0;
+    _m2    = 0.0;
+  }
+
+  size_t count() const
+  {
+    return _count;
+  }
+
+  value_t mean() const
+  {
+    return _mean;
+  }
+
+  // Expected value of the squared deviation, see statistics::calculate_variance
+  value_t variance() const
+  {
+    return _count > 1 ? _m2 / _count : _m2;
+  }
+
+  // Standard deviation of the sample mean ( Central Limit Theorem )
+  value_t mean_std_dev() const
+  {
+    return _count > 1 ? std::sqrt( variance() / _count ) : 0.0;
+  }
+};
+
+/* Bounded memory quantile sketch, using logarithmically sized buckets ( as in
+ * DDSketch ). Quantiles have a relative error of at most relative_accuracy(),
+ * memory depends on the range of the values instead of the number of samples,
+ * and merging costs O(buckets).
+ */
+class quantile_sketch_t
+{
+public:
+  using value_t = double;
+
+  static double relative_accuracy()
+  {
+    return 0.001;
+  }
+
+private:
+  // Upper bound of buckets per sign. When exceeded, the buckets of the
+  // smallest magnitudes are collapsed into one.
+  static const size_t MAX_BUCKETS = 8192;
+
+  // Dense bucket counts, counts[ i ] holds values of bucket index offset + i
+  struct store_t
+  {
+    int offset = 0;
+    std::vector<size_t> counts;
+
+    void add( int index, size_t n )
+    {
+      if ( counts.empty() )
+      {
+        offset = index;
+        counts.push_back( 0 );
+      }
+      else if ( index < offset )
+      {
+        counts.insert( counts.begin(), offset - index, 0 );
+        offset = index;
+      }
+      else if ( index >= offset + static_cast<int>( counts.size() ) )
+      {
+        counts.resize( index - offset + 1, 0 );
+      }
+
+      counts[ index - offset ] += n;
+
+      if ( counts.size() > MAX_BUCKETS )
+      {
+        size_t excess = counts.size() - MAX_BUCKETS;
+        counts[ excess ] += std::accumulate( counts.begin(), counts.begin() + excess, size_t() );
+        counts.erase( counts.begin(), counts.begin() + excess );
+        offset += static_cast<int>( excess );
+      }
+    }
+
+    void merge( const store_t& other )
+    {
+      for ( size_t i = 0; i < other.counts.size(); ++i )
+      {
+        if ( other.counts[ i ] > 0 )
+        {
+          add( other.offset + static_cast<int>( i ), other.counts[ i ] );
+        }
+      }
+    }
+  };
+
+  store_t _positive, _negative;
+  size_t _zero  = 0;
+  size_t _count = 0;
+
+  static double gamma()
+  {
+    return ( 1.0 + relative_accuracy() ) / ( 1.0 - relative_accuracy() );
+  }
+
+  static int index( value_t x )
+  {
+    static const double log_gamma = std::log( gamma() );
+    return static_cast<int>( std::ceil( std::log( x ) / log_gamma ) );
+  }
+
+  // Representative value of a bucket, within relative_accuracy() of all
+  // values in the bucket
+  static value_t value( int index )
+  {
+    return 2.0 * std::pow( gamma(), index ) / ( gamma() + 1.0 );
+  }
+
+public:
+  void add( value_t x )
+  {
+    if ( x > 0 )
+      _positive.add( index( x ), 1 );
+    else if ( x < 0 )
+      _negative.add( index( -x ), 1 );
+    else
+      ++_zero;
+
+    ++_count;
+  }
+
+  void merge( const quantile_sketch_t& other )
+  {
+    _positive.merge( other._positive );
+    _negative.merge( other._negative );
+    _zero += other._zero;
+    _count += other._count;
+  }
+
+  void clear()
+  {
+    *this = quantile_sketch_t();
+  }
+
+  size_t count() const
+  {
+    return _count;
+  }
+
+  // Call f( value, count ) for every non-empty bucket, in ascending order
+  template <typename F>
+  void for_each_bucket( F f ) const
+  {
+    for ( size_t i = _negative.counts.size(); i-- > 0; )
+    {
+      if ( _negative.counts[ i ] > 0 )
+        f( -value( _negative.offset + static_cast<int>( i ) ), _negative.counts[ i ] );
+    }
+
+    if ( _zero > 0 )
+      f( value_t(), _zero );
+
+    for ( size_t i = 0; i < _positive.counts.size(); ++i )
+    {
+      if ( _positive.counts[ i ] > 0 )
+        f( value( _positive.offset + static_cast<int>( i ) ), _positive.counts[ i ] );
+    }
+  }
+
+  // Value of the sample at rank floor( q * ( count - 1 ) ), same as
+  // extended_sample_data_t::percentile on stored samples
+  value_t quantile( double q ) const
+  {
+    if ( _count == 0 )
+      return value_t();
+
+    size_t rank = static_cast<size_t>( q * ( _count - 1 ) );
+    size_t seen = 0;
+    value_t result = value_t();
+    bool found = false;
+
+    for_each_bucket( [ & ]( value_t v, size_t n ) {
+      if ( ! found && seen + n > rank )
+      {
+        result = v;
+        found  = true;
+      }
+      seen += n;
+    } );
+
+    return result;
+  }
+};
+
 /* Extensive sample_data container with two runtime dependent modes:
  * - simple: Only offers sum, count
  *  -!simple: saves data and offers variance, percentiles, distribution, etc.
+ * A !simple container can use a quantile sketch instead of saving data. It
+ * then offers the same statistics with bounded memory, but no raw data.
  */
 class extended_sample_data_t : public simple_sample_data_with_min_max_t
 {
@@ -345,12 +583,24 @@ public:
   value_t _mean, variance, std_dev, mean_variance, mean_std_dev;
   std::vector<size_t> distribution;
   bool simple;
+  bool sketch;
+  bool compact;
 
 private:
   std::vector<value_t> _data;
   std::vector<value_t> _sorted_data;  // extra sequence so we can keep the
                                       // original, unsorted order ( for example
                                       // to do regression on it )
+  running_stats_t _running;           // Mean/variance of _data, kept up to date
+                                      // on every add
+  quantile_sketch_t _sketch;
+  // Compact storage: samples as float offsets from the first sample, with a
+  // compensated ( Kahan ) sum so mean and variance keep double precision.
+  // Samples are only decoded on access, never stored as doubles.
+  std::vector<float> _compact;
+  std::vector<float> _sorted_compact;
+  value_t _anchor;
+  value_t _sum_error;
   bool is_sorted;
 
 public:
@@ -363,6 +613,10 @@ public:
       mean_variance(),
       mean_std_dev(),
       simple( s ),
+      sketch( false ),
+      compact( false ),
+      _anchor(),
+      _sum_error(),
       is_sorted( false )
   {
   }
@@ -374,6 +628,22 @@ public:
     clear();
   }
 
+  // Store !simple data in a quantile sketch instead of saving every sample
+  void use_sketch( bool sketch = true )
+  {
+    this->sketch = sketch;
+
+    clear();
+  }
+
+  // Store !simple data as 32bit floats, at half the memory of full storage
+  void use_compact( bool compact = true )
+  {
+    this->compact = compact;
+
+    clear();
+  }
+
   const char* name() const
   {
     return name_str.c_str();
@@ -382,7 +652,12 @@ public:
   // Reserve memory
   void reserve( std::size_t capacity )
   {
-    if ( !simple )
+    if ( simple || sketch )
+      return;
+
+    if ( compact )
+      _compact.reserve( capacity );
+    else
       _data.reserve( capacity );
   }
 
@@ -393,9 +668,25 @@ public:
     {
       base_t::add( x );
     }
+    else if ( sketch )
+    {
+      base_t::add( x );
+      _running.add( x );
+      _sketch.add( x );
+    }
+    else if ( compact )
+    {
+      if ( _compact.empty() )
+        _anchor = x;
+      _compact.push_back( static_cast<float>( x - _anchor ) );
+      add_compensated( x );
+      _running.add( x );
+      is_sorted = false;
+    }
     else
     {
       _data.push_back( x );
+      _running.add( x );
       is_sorted = false;
     }
   }
@@ -407,7 +698,7 @@ public:
 
   size_t size() const
   {
-    if ( simple )
+    if ( simple || sketch || compact )
       return base_t::count();
 
     return _data.size();
@@ -432,6 +723,20 @@ public:
     if ( simple )
       return;
 
+    if ( sketch )
+    {  // Sum and min/max are tracked on add
+      if ( base_t::count() > 0 )
+        _mean = _running.mean();
+      return;
+    }
+
+    if ( compact )
+    {  // Compensated sum and exact min/max are tracked on add
+      if ( base_t::count() > 0 )
+        _mean = ( base_t::_sum - _sum_error ) / base_t::count();
+      return;
+    }
+
     if ( data().empty() )
       return;
 
@@ -447,8 +752,11 @@ public:
       base_t::set_max( *minmax.second );
     }
 
-    base_t::_sum = statistics::calculate_sum( data() );
-    _mean        = base_t::_sum / data().size();
+    // Sum up in sorted order, so the mean does not depend on the order in which the samples were
+    // collected and merged
+    const auto& values = sorted() ? sorted_data() : data();
+    base_t::_sum = statistics::calculate_sum( values );
+    _mean        = base_t::_sum / values.size();
   }
 
   value_t mean() const
@@ -461,7 +769,7 @@ public:
   }
   size_t count() const
   {
-    return simple ? base_t::count() : data().size();
+    return simple || sketch || compact ? base_t::count() : data().size();
   }
 
   /* Analyze Variance: Variance, Stddev and Stddev of the mean
@@ -472,16 +780,19 @@ public:
     if ( simple )
       return;
 
-    if ( _data.empty() )
+    if ( count() == 0 )
       return;
 
-    variance = statistics::calculate_variance( data(), mean() );
+    if ( sketch || compact )
+      variance = _running.variance();
+    else
+      variance = statistics::calculate_variance( sorted() ? sorted_data() : data(), mean() );
     std_dev  = std::sqrt( variance );
 
     // Calculate Standard Deviation of the Mean ( Central Limit Theorem )
-    if ( data().size() > 1 )
+    if ( count() > 1 )
     {
-      mean_variance = variance / data().size();
+      mean_variance = variance / count();
       mean_std_dev  = std::sqrt( mean_variance );
     }
   }
@@ -498,8 +809,21 @@ public:
     {
       return;
     }
-    _sorted_data = _data;
-    range::sort( _sorted_data );
+    if ( sketch )
+    {  // Sketch buckets are always ordered
+      is_sorted = true;
+      return;
+    }
+    if ( compact )
+    {
+      _sorted_compact = _compact;
+      range::sort( _sorted_compact );
+    }
+    else
+    {
+      _sorted_data = data();
+      range::sort( _sorted_data );
+    }
     is_sorted = true;
   }
 
@@ -512,11 +836,40 @@ public:
     if ( simple )
       return;
 
-    if ( data().empty() )
+    if ( count() == 0 )
       return;
 
-    distribution = statistics::create_histogram( data(), num_buckets,
-                                                 base_t::min(), base_t::max() );
+    distribution = histogram( num_buckets, base_t::min(), base_t::max() );
+  }
+
+  /* Histogram ( not normalized ) of the data within [min, max]. Sketch data
+   * is binned by the representative value of each sketch bucket.
+   */
+  std::vector<size_t> histogram( size_t num_buckets, value_t min,
+                                 value_t max ) const
+  {
+    if ( !sketch && !compact )
+      return statistics::create_histogram( data(), num_buckets, min, max );
+
+    std::vector<size_t> result;
+    if ( base_t::count() == 0 || max <= min )
+      return result;
+
+    result.assign( num_buckets, size_t{} );
+    auto add_to_bucket = [ & ]( value_t v, size_t n ) {
+      auto position = ( clamp( v, min, max ) - min ) / ( max - min );
+      size_t index  = std::min( static_cast<size_t>( num_buckets * position ),
+                               num_buckets - 1 );
+      result[ index ] += n;
+    };
+
+    if ( sketch )
+      _sketch.for_each_bucket( add_to_bucket );
+    else
+      for ( size_t i = 0, end = _compact.size(); i < end; ++i )
+        add_to_bucket( sample( i ), 1 );
+
+    return result;
   }
 
   void clear()
@@ -525,7 +878,20 @@ public:
     base_t::_sum   = 0.0;
     _sorted_data.clear();
     _data.clear();
+    _compact.clear();
+    _sorted_compact.clear();
+    _running.clear();
     distribution.clear();
+    _anchor    = 0.0;
+    _sum_error = 0.0;
+
+    if ( sketch || compact )
+    {
+      _sketch.clear();
+      base_t::_found = false;
+      base_t::_min   = std::numeric_limits<value_t>::max();
+      base_t::_max   = std::numeric_limits<value_t>::lowest();
+    }
   }
 
   // Access functions
@@ -538,20 +904,48 @@ public:
     if ( simple )
       return 0;
 
-    if ( data().empty() )
+    if ( count() == 0 )
       return 0;
 
+    if ( sketch )
+    {  // Min/max are exact, everything in between is a bucket estimate
+      if ( x == 0.0 )
+        return base_t::min();
+      if ( x == 1.0 )
+        return base_t::max();
+      return clamp( _sketch.quantile( x ), base_t::min(), base_t::max() );
+    }
+
     if ( !is_sorted )
       return base_t::nan();
 
+    if ( compact )
+      return decode( _sorted_compact[ (int)( x * ( _sorted_compact.size() - 1 ) ) ] );
+
     // Should be improved to use linear interpolation
     return ( sorted_data()[ (int)( x * ( sorted_data().size() - 1 ) ) ] );
   }
 
+  // Raw samples of full storage. Empty in simple, sketch and compact mode,
+  // use stored_samples() and sample() to read compact samples.
   const std::vector<value_t>& data() const
   {
     return _data;
   }
+  // Number of stored samples ( full or compact storage ), in collection order
+  size_t stored_samples() const
+  {
+    return compact ? _compact.size() : _data.size();
+  }
+  value_t sample( size_t i ) const
+  {
+    return compact ? decode( _compact[ i ] ) : _data[ i ];
+  }
+  // Streaming mean/variance of the samples, available without analyzing
+  const running_stats_t& running_stats() const
+  {
+    return _running;
+  }
   const std::vector<value_t>& sorted_data() const
   {
     return _sorted_data;
@@ -560,13 +954,52 @@ public:
   void merge( const extended_sample_data_t& other )
   {
     assert( simple == other.simple );
+    assert( sketch == other.sketch );
+    assert( compact == other.compact );
 
     if ( simple )
     {
       base_t::merge( other );
     }
+    else if ( sketch )
+    {
+      base_t::merge( other );
+      _running.merge( other._running );
+      _sketch.merge( other._sketch );
+    }
+    else if ( compact )
+    {
+      if ( other._compact.empty() )
+        return;
+
+      if ( _compact.empty() )
+      {
+        _anchor = other._anchor;
+        _compact = other._compact;
+      }
+      else
+      {  // Rebase the other offsets onto our anchor
+        auto shift = other._anchor - _anchor;
+        _compact.reserve( _compact.size() + other._compact.size() );
+        for ( auto d : other._compact )
+          _compact.push_back( static_cast<float>( shift + d ) );
+      }
+
+      auto sum = base_t::_sum, sum_error = _sum_error;
+      base_t::merge( other );
+      base_t::_sum = sum;
+      _sum_error = sum_error;
+      add_to_sum( other._sum );
+      add_to_sum( -other._sum_error );
+      _running.merge( other._running );
+      is_sorted = false;
+    }
     else
+    {
       _data.insert( _data.end(), other._data.begin(), other._data.end() );
+      _running.merge( other._running );
+      is_sorted = false;
+    }
   }
 
   std::ostream& data_str( std::ostream& s ) const
@@ -576,18 +1009,47 @@ public:
       << " mean variance: " << mean_variance
       << " mean_std_dev: " << mean_std_dev << "\n";
 
-    if ( !data().empty() )
+    if ( stored_samples() > 0 )
       s << "data: ";
-    for ( size_t i = 0, size = data().size(); i < size; ++i )
+    for ( size_t i = 0, size = stored_samples(); i < size; ++i )
     {
       if ( i > 0 )
         s << ", ";
-      s << data()[ i ];
+      s << sample( i );
     }
     s << "\n";
     return s;
   }
 
+
+private:
+  // Compact samples are decoded within the exact min/max, so histograms and
+  // percentiles stay in range
+  value_t decode( float offset ) const
+  {
+    return clamp( _anchor + offset, base_t::_min, base_t::_max );
+  }
+
+  // Kahan summation step on the base sum
+  void add_to_sum( value_t x )
+  {
+    value_t y = x - _sum_error;
+    value_t t = base_t::_sum + y;
+    _sum_error = ( t - base_t::_sum ) - y;
+    base_t::_sum = t;
+  }
+
+  // Count, min/max and compensated sum of a new sample
+  void add_compensated( value_t x )
+  {
+    ++base_t::_count;
+    add_to_sum( x );
+
+    if ( x < base_t::_min )
+      base_t::set_min( x );
+    if ( x > base_t::_max )
+      base_t::set_max( x );
+  }
 };  // sample_data_t
 
 #endif  // SAMPLE_DATA_HPP
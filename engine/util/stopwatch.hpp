@@ -24,7 +24,8 @@ public:
   void mark();
   void accumulate();
   double elapsed();
-  double current();
+  double current() const;
+  stopwatch_t& operator+=( const stopwatch_t& other );
   stopwatch_t( stopwatch_e sw_type );
 private:
   stopwatch_e type;
@@ -38,6 +39,14 @@ inline void stopwatch_t::mark()
   _start = now();
 }
 
+/// Add accumulated time of another stopwatch
+inline stopwatch_t& stopwatch_t::operator+=( const stopwatch_t& other )
+{
+  _current.sec += other._current.sec;
+  _current.usec += other._current.usec;
+  return *this;
+}
+
 /// Create new stopwatch and mark starting timepoint
 inline stopwatch_t::stopwatch_t( stopwatch_e t ) :
     type( t )
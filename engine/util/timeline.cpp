@@ -4,10 +4,29 @@
 
 int main( int /*argc*/, char** /*argv*/ )
 {
-  tl::timeline_t<double> x;
+  timeline_t x, y;
+  x.reserve( 16 );
 
-  std::cout << sizeof( double );
+  for ( size_t i = 0; i < 11; ++i )
+    x.add( i, 2.0 * i );
+  for ( size_t i = 0; i < 7; ++i )
+    y.add( i, 1.0 );
 
-  return 0;
+  x.merge( y );
+  x.adjust( std::vector<double>( 9, 2.0 ) );
+
+  bool ok = x.data().size() == 11;
+  for ( size_t i = 0; i < x.data().size(); ++i )
+  {
+    double expected = 2.0 * i + ( i < 7 ? 1.0 : 0.0 );
+    if ( i < 9 )
+      expected /= 2.0;
+    ok = ok && x.data()[ i ] == expected;
+  }
+
+  x.data_str( std::cout );
+  std::cout << ( ok ? "PASS" : "FAIL" ) << "\n";
+
+  return ok ? 0 : 1;
 }
 #endif // UNIT_TEST
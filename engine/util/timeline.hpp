@@ -16,6 +16,11 @@
 #include "sample_data.hpp"
 #include "sc_timespan.hpp"
 
+#if defined(__SSE2__) || ( defined( SC_VS ) && ( defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) ) )
+#  define TIMELINE_USE_SSE2
+#  include <emmintrin.h>
+#endif
+
 struct sim_t;
 
 template <typename Fwd, typename Out>
@@ -94,32 +99,21 @@ public:
   void resize( size_t length )
   { _data.resize( length ); }
 
+  // Reserve capacity for 'length' entries without changing the timeline length
+  void reserve( size_t length )
+  { _data.reserve( length ); }
+
   // Add 'value' at the specific index
   void add( size_t index, double value )
   {
-    if ( index >= _data.capacity() ) // we need to reallocate
-    {
-      // Reserve data less aggressively than doubling the size every time
-      _data.reserve( std::max( size_t( 10 ), static_cast<size_t>( index * 1.25 ) ) );
-      _data.resize( index + 1 );
-    }
-    else if ( index >= _data.size() ) // we still have enough capacity left, but need to resize up to index
-    {
-      _data.resize( index + 1 );
-    }
-    _data.at( index ) += value;
+    if ( index >= _data.size() )
+      grow( index );
+    _data[ index ] += value;
   }
 
   // Adjust timeline by dividing through divisor timeline
-  template <class A>
-  void adjust( const std::vector<A>& divisor_timeline )
-  {
-
-    for ( size_t j = 0, size = std::min( data().size(), divisor_timeline.size() ); j < size; j++ )
-    {
-      _data[ j ] /= divisor_timeline[ j ];
-    }
-  }
+  void adjust( const std::vector<double>& divisor_timeline )
+  { div_n( _data.data(), divisor_timeline.data(), std::min( data().size(), divisor_timeline.size() ) ); }
 
   double mean() const
   { 
@@ -141,8 +135,7 @@ public:
   void merge( const timeline_t& other )
   {
     // merge shared range
-    for ( size_t j = 0, num_buckets = std::min( _data.size(), other.data().size() ); j < num_buckets; ++j )
-      _data[ j ] += other.data()[ j ];
+    add_n( _data.data(), other.data().data(), std::min( _data.size(), other.data().size() ) );
 
     // if other is larger, insert tail
     if ( _data.size() < other.data().size() )
@@ -177,6 +170,53 @@ public:
     s << "\n";
     return s;
   }
+
+private:
+  // Extend the timeline up to and including index. Pre-sized timelines only reallocate if the
+  // fight runs past the reserved length.
+  void grow( size_t index )
+  {
+    if ( index >= _data.capacity() )
+    {
+      // Reserve data less aggressively than doubling the size every time
+      _data.reserve( std::max( size_t( 10 ), static_cast<size_t>( index * 1.25 ) ) );
+    }
+    _data.resize( index + 1 );
+  }
+
+  // dst[ i ] += src[ i ], two lanes at a time where SSE2 is available
+  static void add_n( double* dst, const double* src, size_t n )
+  {
+    size_t i = 0;
+#if defined( TIMELINE_USE_SSE2 )
+    for ( ; i + 4 <= n; i += 4 )
+    {
+      __m128d a = _mm_add_pd( _mm_loadu_pd( dst + i ), _mm_loadu_pd( src + i ) );
+      __m128d b = _mm_add_pd( _mm_loadu_pd( dst + i + 2 ), _mm_loadu_pd( src + i + 2 ) );
+      _mm_storeu_pd( dst + i, a );
+      _mm_storeu_pd( dst + i + 2, b );
+    }
+#endif
+    for ( ; i < n; ++i )
+      dst[ i ] += src[ i ];
+  }
+
+  // dst[ i ] /= src[ i ], two lanes at a time where SSE2 is available
+  static void div_n( double* dst, const double* src, size_t n )
+  {
+    size_t i = 0;
+#if defined( TIMELINE_USE_SSE2 )
+    for ( ; i + 4 <= n; i += 4 )
+    {
+      __m128d a = _mm_div_pd( _mm_loadu_pd( dst + i ), _mm_loadu_pd( src + i ) );
+      __m128d b = _mm_div_pd( _mm_loadu_pd( dst + i + 2 ), _mm_loadu_pd( src + i + 2 ) );
+      _mm_storeu_pd( dst + i, a );
+      _mm_storeu_pd( dst + i + 2, b );
+    }
+#endif
+    for ( ; i < n; ++i )
+      dst[ i ] /= src[ i ];
+  }
   /*
     // Functions which could be implemented:
     data_type variance() const;
@@ -250,11 +290,11 @@ public:
    */
   void create_histogram( const extended_sample_data_t& sd, size_t num_buckets, double min, double max )
   {
-    if ( sd.simple || sd.data().empty() )
+    if ( sd.simple || sd.count() == 0 )
       return;
     clear();
     _min = min; _max = max;
-    _data = statistics::create_histogram( sd.data(), num_buckets, _min, _max );
+    _data = sd.histogram( num_buckets, _min, _max );
     calculate_num_entries();
   }
 
@@ -262,8 +302,14 @@ public:
    */
   void create_histogram( const extended_sample_data_t& sd, size_t num_buckets )
   {
-    if ( sd.simple || sd.data().empty() )
+    if ( sd.simple || sd.count() == 0 )
       return;
+    // Sketch and compact storage track exact min/max, and keep no raw data
+    if ( sd.sketch || sd.compact )
+    {
+      create_histogram( sd, num_buckets, sd.min(), sd.max() );
+      return;
+    }
     double min = *std::min_element( sd.data().begin(), sd.data().end() );
     double max = *std::max_element( sd.data().begin(), sd.data().end() );
     create_histogram( sd, num_buckets, min, max );
@@ -361,6 +407,7 @@ struct sc_timeline_t : public timeline_t
 {
   typedef timeline_t base_t;
   using timeline_t::add;
+  using timeline_t::reserve;
   double bin_size;
 
   sc_timeline_t() : timeline_t(), bin_size( 1.0 ) {}
@@ -375,6 +422,10 @@ struct sc_timeline_t : public timeline_t
     return bin_size;
   }
 
+  // Reserve capacity for a fight of the given length
+  void reserve( timespan_t length )
+  { base_t::reserve( static_cast<size_t>( length.total_seconds() / bin_size ) + 1 ); }
+
   // Add 'value' at the corresponding time
   void add( timespan_t current_time, double value )
   { base_t::add( static_cast<size_t>( current_time.total_millis() / 1000 / bin_size ), value ); }
@@ -385,9 +436,9 @@ struct sc_timeline_t : public timeline_t
     size_t index = static_cast<size_t>( current_time.total_millis() / 1000 / bin_size );
     if ( data().size() == 0 || data().size() <= index )
       add( current_time, new_value );
-    else if ( new_value > data().at( index ) )
+    else if ( new_value > data()[ index ] )
     {
-      add( current_time, new_value - data().at( index ) );
+      add( current_time, new_value - data()[ index ] );
     }
   }
 